@@ -13,14 +13,126 @@ from tkinter import ttk, messagebox, simpledialog
 import networkx as nx
 import matplotlib.pyplot as plt
 from matplotlib.backends.backend_tkagg import FigureCanvasTkAgg
+from matplotlib.collections import LineCollection
 from matplotlib.figure import Figure
 import os
+import subprocess
+import threading
 from datetime import datetime
 import time
 import random
 import math
 
 
+# Maps with more cities than this are drawn from the backend's render feed
+LOD_THRESHOLD = 300
+
+# Background map loading: progress poll period and lines between progress updates
+LOAD_POLL_MS = 100
+LOAD_PROGRESS_LINES = 50000
+
+
+def backend_executable():
+    """Path to the compiled C backend, or None if it has not been built"""
+    exe_name = "city_nav.exe" if os.name == "nt" else "city_nav"
+    exe_path = os.path.abspath(os.path.join("build", exe_name))
+    return exe_path if os.path.exists(exe_path) else None
+
+
+def decode_polyline(text, dims=2):
+    """Decode a backend polyline token into a list of dims-tuples of ints"""
+    values, value, shift = [], 0, 0
+    for ch in text:
+        b = ord(ch) - 63
+        value |= (b & 0x1F) << shift
+        shift += 5
+        if b < 0x20:
+            values.append(~(value >> 1) if value & 1 else value >> 1)
+            value, shift = 0, 0
+
+    points, prev = [], [0] * dims
+    for i in range(0, len(values) - dims + 1, dims):
+        prev = [p + d for p, d in zip(prev, values[i : i + dims])]
+        points.append(tuple(prev))
+    return points
+
+
+class BackendClient:
+    """Line-protocol client for the C backend running in --serve mode"""
+
+    def __init__(self):
+        self.proc = None
+        self.next_tag = 0
+        self.events = []  # Change events broadcast by the backend
+        self.load_stage = None  # Backend's background load stage ("ready" when done)
+
+        exe_path = backend_executable()
+        if not exe_path:
+            return
+
+        try:
+            # Backend reads cities.txt / roads.txt from its working directory
+            self.proc = subprocess.Popen(
+                [exe_path, "--serve"],
+                cwd="data",
+                stdin=subprocess.PIPE,
+                stdout=subprocess.PIPE,
+                stderr=subprocess.DEVNULL,
+                text=True,
+                bufsize=1,
+            )
+        except OSError:
+            self.proc = None
+
+    def available(self):
+        return self.proc is not None and self.proc.poll() is None
+
+    def request(self, command):
+        """Send one command, return the response tokens after the tag"""
+        if not self.available():
+            return None
+
+        self.next_tag += 1
+        tag = f"g{self.next_tag}"
+        try:
+            self.proc.stdin.write(f"{tag} {command}\n")
+            self.proc.stdin.flush()
+            while True:
+                line = self.proc.stdout.readline()
+                if not line:
+                    return None
+                parts = line.split()
+                if parts and parts[0] == "*" and len(parts) > 3 and parts[2] == "LOAD":
+                    self.load_stage = parts[3]
+                elif parts and parts[0] == "*" and len(parts) > 2:
+                    self.events.append(self.parse_event(parts[2], parts[3:]))
+                elif parts and parts[0] == tag:
+                    return parts[1:]
+        except (OSError, ValueError):
+            return None
+
+    @staticmethod
+    def parse_event(kind, args):
+        """'* EVENT <kind> args' line -> event tuple"""
+        if kind == "PATH_HIGHLIGHTED":
+            return (kind, [int(a) for a in args[1:]])
+        if kind in ("CITY_ADDED", "CITY_UPDATED"):
+            return (kind, int(args[0]), int(args[1]), int(args[2]), " ".join(args[3:]))
+        return (kind,) + tuple(int(a) for a in args)
+
+    def drain_events(self):
+        events, self.events = self.events, []
+        return events
+
+    def close(self):
+        if self.available():
+            try:
+                self.proc.stdin.write("q QUIT\n")
+                self.proc.stdin.flush()
+            except OSError:
+                pass
+
+
 class MultiInputDialog:
     """Custom dialog for multiple inputs"""
 
@@ -238,11 +350,19 @@ class CityNavigationGUI:
         # Dataset storage (for random generation) 
         self.dataset_cities = {}  
 
-        # Setup UI first, then load data, then draw
+        # Level-of-detail rendering through the C backend (large maps)
+        self.backend = BackendClient()
+        self.view = None  # (min_x, min_y, max_x, max_y) in city coordinates
+        self.drag_start = None
+        self.lod_path = None
+        self.lod_edges = None
+        self.scene = None
+        self.load_generation = 0  # Bumped per load_data call; stale loads are dropped
+
+        # Setup UI first, then load the active map in the background and draw it
         self.setup_ui()
         self.load_dataset()  
-        self.load_data()  # Load active map
-        self.draw_graph()
+        self.load_data(on_loaded=self.draw_graph)
 
     def setup_ui(self):
         """Setup the user interface"""
@@ -317,6 +437,11 @@ class CityNavigationGUI:
         self.canvas = FigureCanvasTkAgg(self.fig, center_panel)
         self.canvas.get_tk_widget().pack(fill=tk.BOTH, expand=True)
 
+        # Pan (drag) and zoom (scroll) for large maps
+        self.canvas.mpl_connect("scroll_event", self.on_scroll)
+        self.canvas.mpl_connect("button_press_event", self.on_press)
+        self.canvas.mpl_connect("button_release_event", self.on_release)
+
         # RIGHT PANEL - City Directory
         right_panel = ttk.Frame(main_frame, width=280)
         right_panel.pack(side=tk.RIGHT, fill=tk.BOTH)
@@ -398,6 +523,7 @@ class CityNavigationGUI:
         buttons = [
             ("🔍 Find Path (Dijkstra)", self.find_shortest_path_dijkstra, "#89b4fa"),
             ("⭐ Find Path (A*)", self.find_shortest_path_astar, "#f38ba8"),
+            ("🧭 Route via Stops", self.find_route_via, "#f5c2e7"),
             ("🌊 BFS Traversal", self.bfs_traversal, "#a6e3a1"),
             ("🌲 DFS Traversal", self.dfs_traversal, "#fab387"),
             ("🎲 Generate Random Map", self.generate_random_map, "#cba6f7"),
@@ -467,21 +593,32 @@ class CityNavigationGUI:
         self.city_info_text.insert(1.0, info)
         self.city_info_text.config(state=tk.DISABLED)
 
-    def load_data(self):
-        """Load cities and roads from text files"""
-        try:
-            if not os.path.exists("data/cities.txt"):
-                self.log_info("⚠️ data/cities.txt not found!")
-                return
+    def load_data(self, on_loaded=None):
+        """Load cities and roads on a worker thread, then swap them in
 
-            if not os.path.exists("data/roads.txt"):
-                self.log_info("⚠️ data/roads.txt not found!")
-                return
+        The window stays responsive; the status bar shows progress and
+        on_loaded runs on the Tk thread once the new map is in place.
+        """
+        if not os.path.exists("data/cities.txt"):
+            self.log_info("⚠️ data/cities.txt not found!")
+            return
 
-            # Clear existing data  
-            self.graph.clear()
-            self.cities.clear()
-            self.pos.clear()
+        if not os.path.exists("data/roads.txt"):
+            self.log_info("⚠️ data/roads.txt not found!")
+            return
+
+        self.load_generation += 1
+        progress = {"stage": "cities", "cities": 0, "roads": 0, "result": None, "error": None}
+        threading.Thread(target=self.read_map_files, args=(progress,), daemon=True).start()
+        self.poll_load(self.load_generation, progress, on_loaded)
+
+    @staticmethod
+    def read_map_files(progress):
+        """Worker thread: parse the map into a fresh graph (no Tk calls here)"""
+        try:
+            graph = nx.DiGraph()
+            cities = {}
+            pos = {}
 
             # Load cities
             with open("data/cities.txt", "r") as f:
@@ -493,11 +630,17 @@ class CityNavigationGUI:
                         name = parts[1]
                         x = int(parts[2])
                         y = int(parts[3])
-                        self.cities[city_id] = {"name": name, "x": x, "y": y}
-                        self.graph.add_node(city_id, name=name, pos=(x, y))
-                        self.pos[city_id] = (x, y)
+                        cities[city_id] = {"name": name, "x": x, "y": y}
+                        graph.add_node(city_id, name=name, pos=(x, y))
+                        pos[city_id] = (x, y)
+                        if len(cities) % LOAD_PROGRESS_LINES == 0:
+                            progress["cities"] = len(cities)
+
+            progress["cities"] = len(cities)
+            progress["stage"] = "roads"
 
             # Load roads
+            roads = 0
             with open("data/roads.txt", "r") as f:
                 next(f)
                 for line in f:
@@ -506,18 +649,46 @@ class CityNavigationGUI:
                         from_id = int(parts[0])
                         to_id = int(parts[1])
                         dist = int(parts[2])
-                        self.graph.add_edge(from_id, to_id, weight=dist)
+                        graph.add_edge(from_id, to_id, weight=dist)
+                        roads += 1
+                        if roads % LOAD_PROGRESS_LINES == 0:
+                            progress["roads"] = roads
 
-            self.log_info(
-                f"✅ Loaded {len(self.cities)} cities and {self.graph.number_of_edges()} roads"
-            )
+            progress["roads"] = roads
+            progress["result"] = (graph, cities, pos)
+        except Exception as e:
+            progress["error"] = e
+
+    def poll_load(self, generation, progress, on_loaded):
+        """Tk thread: report progress until the worker finishes, then swap in"""
+        if generation != self.load_generation:
+            return  # Superseded by a newer load
+
+        if progress["result"] is None and progress["error"] is None:
             self.status_label.config(
-                text=f"✅ Loaded {len(self.cities)} cities, {self.graph.number_of_edges()} roads"
+                text=f"⏳ Loading {progress['stage']}: {progress['cities']} cities, "
+                f"{progress['roads']} roads"
             )
-            self.update_city_list()
+            self.root.after(LOAD_POLL_MS, self.poll_load, generation, progress, on_loaded)
+            return
 
-        except Exception as e:
-            self.log_info(f"❌ Error: {e}")
+        if progress["error"] is not None:
+            self.log_info(f"❌ Error: {progress['error']}")
+            self.status_label.config(text="❌ Load failed")
+            return
+
+        self.graph, self.cities, self.pos = progress["result"]
+        self.view = None
+
+        self.log_info(
+            f"✅ Loaded {len(self.cities)} cities and {self.graph.number_of_edges()} roads"
+        )
+        self.status_label.config(
+            text=f"✅ Loaded {len(self.cities)} cities, {self.graph.number_of_edges()} roads"
+        )
+        self.update_city_list()
+        if on_loaded:
+            on_loaded()
 
     # RANDOM MAP GENERATION 
     def load_dataset(self):
@@ -544,7 +715,12 @@ class CityNavigationGUI:
             self.log_info(f"⚠️ Dataset load error: {e}")
 
     def generate_random_map(self):
-        """Generate a random 8-city, 13-edge map"""
+        """Generate a random map, with the C generator when it is built"""
+        exe_path = backend_executable()
+        if exe_path:
+            self.generate_native_map(exe_path)
+            return
+
         if not self.dataset_cities:
             messagebox.showerror(
                 "Error", "Dataset not loaded! Place dataset_cities.txt in data/ folder."
@@ -586,8 +762,7 @@ class CityNavigationGUI:
             self.save_generated_map(selected_cities, coordinates, edges_with_distances)
 
             # Step 5: Reload GUI
-            self.load_data()
-            self.draw_graph()
+            self.load_data(on_loaded=self.draw_graph)
 
             self.log_info("✅ Random map generated successfully!")
             self.status_label.config(text="✅ Random map loaded")
@@ -602,6 +777,45 @@ class CityNavigationGUI:
             messagebox.showerror("Error", f"Generation failed: {e}")
             self.status_label.config(text="❌ Generation failed")
 
+    def generate_native_map(self, exe_path):
+        """Run city_nav --generate for maps of any size"""
+        num_cities = simpledialog.askinteger(
+            "Generate Random Map",
+            "Number of cities:",
+            initialvalue=8,
+            minvalue=2,
+            maxvalue=5000000,
+            parent=self.root,
+        )
+        if not num_cities:
+            return
+
+        self.log_info(f"\n🎲 GENERATING RANDOM MAP ({num_cities} cities)\n" + "=" * 40)
+        self.status_label.config(text="⏳ Generating...")
+        self.root.update()
+
+        seed = str(random.randrange(1 << 32))
+        result = subprocess.run(
+            [exe_path, "--generate", str(num_cities), "cities.txt", "roads.txt", seed],
+            cwd="data",
+            capture_output=True,
+            text=True,
+        )
+        for line in result.stdout.splitlines():
+            self.log_info(line)
+        if result.returncode != 0:
+            messagebox.showerror("Error", "Generation failed! See the info panel.")
+            self.status_label.config(text="❌ Generation failed")
+            return
+
+        # Backend serves the old map until restarted
+        self.backend.close()
+        self.backend = BackendClient()
+
+        self.load_data(on_loaded=self.draw_graph)
+        self.log_info("✅ Random map generated successfully!")
+        self.status_label.config(text="✅ Random map loaded")
+
     def generate_coordinates_with_spacing(self, num_cities, min_distance=150):
         """Generate non-overlapping coordinates for cities"""
         coordinates = []
@@ -757,8 +971,7 @@ class CityNavigationGUI:
             shutil.copy("data/default_cities.txt", "data/cities.txt")
             shutil.copy("data/default_roads.txt", "data/roads.txt")
 
-            self.load_data()
-            self.draw_graph()
+            self.load_data(on_loaded=self.draw_graph)
 
             self.log_info("🔄 Default map restored!")
             self.status_label.config(text="✅ Default map loaded")
@@ -823,6 +1036,7 @@ class CityNavigationGUI:
             highlight_edges: List of (u,v) edge tuples to highlight (for BFS/DFS tree)
         """
         self.ax.clear()
+        self.scene = None
 
         if not self.graph.nodes():
             self.ax.text(
@@ -837,6 +1051,12 @@ class CityNavigationGUI:
             self.canvas.draw()
             return
 
+        if len(self.cities) > LOD_THRESHOLD and self.backend.available():
+            self.lod_path = highlight_path
+            self.lod_edges = highlight_edges
+            self.draw_render_feed()
+            return
+
         # Determine which nodes to highlight
         highlighted_nodes = set()
         if highlight_path:
@@ -893,60 +1113,33 @@ class CityNavigationGUI:
             else:
                 non_path_edges.append((u, v))
 
+        # Artists per element, so later changes can update them in place
+        self.scene = {
+            "edges": {},
+            "edge_labels": {},
+            "labels": {},
+            "nodes": None,
+            "node_order": [],
+            "node_colors": node_colors,
+            "node_sizes": node_sizes,
+            "path": list(highlight_path) if highlight_path else [],
+            "tree": bool(highlight_edges),
+        }
+
         # Draw non-path edges
         if non_path_edges:
-            edge_color = "#b0b2bf" if highlight_path else "#ffffff"
-            edge_width = 1.5 if highlight_path else 2.5
-            edge_alpha = 0.6 if highlight_path else 0.8
-            nx.draw_networkx_edges(
-                self.graph,
-                self.pos,
-                edgelist=non_path_edges,
-                edge_color=edge_color,
-                width=edge_width,
-                ax=self.ax,
-                alpha=edge_alpha,
-                arrows=True,
-                arrowsize=25,
-                arrowstyle="->",
-                connectionstyle="arc3,rad=0.20",
-                min_source_margin=24,
-                min_target_margin=24,
-            )
+            self.draw_edge_artists(non_path_edges, False, bool(highlight_path))
 
         # Draw path edges - BRIGHT YELLOW
         if path_edges:
-            nx.draw_networkx_edges(
-                self.graph,
-                self.pos,
-                edgelist=path_edges,
-                edge_color="#f9e2af",
-                width=5,
-                ax=self.ax,
-                alpha=0.95,
-                arrows=True,
-                arrowsize=32,
-                arrowstyle="->",
-                connectionstyle="arc3,rad=0.20",
-                min_source_margin=25,
-                min_target_margin=25,
-            )
+            self.draw_edge_artists(path_edges, True, True)
 
         # Draw nodes with WHITE OUTLINE
-        nx.draw_networkx_nodes(
-            self.graph,
-            self.pos,
-            node_color=node_colors,
-            node_size=node_sizes,
-            ax=self.ax,
-            alpha=0.95,
-            edgecolors="#ffffff",
-            linewidths=3,
-        )
+        self.draw_node_artists()
 
         # Draw city name labels
         labels = {node: self.cities[node]["name"] for node in self.graph.nodes()}
-        nx.draw_networkx_labels(
+        self.scene["labels"] = nx.draw_networkx_labels(
             self.graph,
             self.pos,
             labels,
@@ -958,73 +1151,399 @@ class CityNavigationGUI:
 
         # Draw edge labels (distances)
         edge_labels = nx.get_edge_attributes(self.graph, "weight")
-        rad = 0.20  
+        path_edge_set = set(path_edges)
         for edge, label in edge_labels.items():
-            u, v = edge
-            xu, yu = self.pos[u]
-            xv, yv = self.pos[v]
+            self.draw_edge_label(edge, label, edge in path_edge_set)
 
-            # Straight-line midpoint
-            mx = (xu + xv) / 2
-            my = (yu + yv) / 2
+        self.ax.set_title(
+            "City Navigation Network",
+            color="#cdd6f4",
+            fontsize=16,
+            pad=20,
+            weight="bold",
+        )
+        self.ax.axis("off")
+        self.ax.margins(0.15)
+        self.canvas.draw()
 
-            # Edge length
-            edge_len = ((xv - xu) ** 2 + (yv - yu) ** 2) ** 0.5
-            if edge_len == 0:
-                continue
+    # SCENE ARTISTS
 
-            # Perpendicular direction
-            perp_x = -(yv - yu) / edge_len
-            perp_y = (xv - xu) / edge_len
+    def draw_edge_artists(self, edges, on_path, path_shown):
+        """Draw edges and remember one arrow artist per edge"""
+        if on_path:
+            style = dict(edge_color="#f9e2af", width=5, alpha=0.95, arrowsize=32,
+                         min_source_margin=25, min_target_margin=25)
+        else:
+            style = dict(
+                edge_color="#b0b2bf" if path_shown else "#ffffff",
+                width=1.5 if path_shown else 2.5,
+                alpha=0.6 if path_shown else 0.8,
+                arrowsize=25,
+                min_source_margin=24,
+                min_target_margin=24,
+            )
+        artists = nx.draw_networkx_edges(
+            self.graph,
+            self.pos,
+            edgelist=edges,
+            ax=self.ax,
+            arrows=True,
+            arrowstyle="->",
+            connectionstyle="arc3,rad=0.20",
+            **style,
+        )
+        for edge, artist in zip(edges, artists):
+            self.scene["edges"][edge] = artist
+
+    def draw_node_artists(self):
+        """(Re)draw the node collection - one artist for all cities"""
+        if self.scene["nodes"] is not None:
+            self.scene["nodes"].remove()
+        self.scene["node_order"] = list(self.graph.nodes())
+        self.scene["nodes"] = nx.draw_networkx_nodes(
+            self.graph,
+            self.pos,
+            nodelist=self.scene["node_order"],
+            node_color=self.scene["node_colors"],
+            node_size=self.scene["node_sizes"],
+            ax=self.ax,
+            alpha=0.95,
+            edgecolors="#ffffff",
+            linewidths=3,
+        )
 
-            # Arc3 Bezier curve math:
-            # - Control point is at: midpoint + (rad * edge_len) perpendicular offset
-            # - Curve midpoint at t=0.5: midpoint + 0.5 * (rad * edge_len) perpendicular offset
-            curve_offset = 0.5 * rad * edge_len
+    def draw_edge_label(self, edge, label, on_path):
+        """Draw one distance label on its curved edge"""
+        rad = 0.20
+        u, v = edge
+        xu, yu = self.pos[u]
+        xv, yv = self.pos[v]
 
-            # Place label on the curve
-            label_x = mx + perp_x * curve_offset
-            label_y = my + perp_y * curve_offset
+        # Straight-line midpoint
+        mx = (xu + xv) / 2
+        my = (yu + yv) / 2
 
-            # normal and path style
-            if path_edges and edge in path_edges:
-                color = "#a6e3a1"
-                size = 13
-                alpha = 0.95
-            else:
-                color = "#94e2d5"
-                size = 12
-                alpha = 0.9
+        # Edge length
+        edge_len = ((xv - xu) ** 2 + (yv - yu) ** 2) ** 0.5
+        if edge_len == 0:
+            return
 
-            self.ax.text(
-                label_x,
-                label_y,
-                str(int(label)),
-                fontsize=size,
-                color=color,
-                ha="center",
-                va="center",
-                fontweight="bold",
-                bbox=dict(
-                    boxstyle="round,pad=0.3",
-                    facecolor="#1e1e2e",
-                    edgecolor="white",
-                    alpha=alpha,
-                    linewidth=0.5,
-                ),
+        # Perpendicular direction
+        perp_x = -(yv - yu) / edge_len
+        perp_y = (xv - xu) / edge_len
+
+        # Arc3 Bezier curve math:
+        # - Control point is at: midpoint + (rad * edge_len) perpendicular offset
+        # - Curve midpoint at t=0.5: midpoint + 0.5 * (rad * edge_len) perpendicular offset
+        curve_offset = 0.5 * rad * edge_len
+
+        # Place label on the curve
+        label_x = mx + perp_x * curve_offset
+        label_y = my + perp_y * curve_offset
+
+        # normal and path style
+        if on_path:
+            color = "#a6e3a1"
+            size = 13
+            alpha = 0.95
+        else:
+            color = "#94e2d5"
+            size = 12
+            alpha = 0.9
+
+        self.scene["edge_labels"][edge] = self.ax.text(
+            label_x,
+            label_y,
+            str(int(label)),
+            fontsize=size,
+            color=color,
+            ha="center",
+            va="center",
+            fontweight="bold",
+            bbox=dict(
+                boxstyle="round,pad=0.3",
+                facecolor="#1e1e2e",
+                edgecolor="white",
+                alpha=alpha,
+                linewidth=0.5,
+            ),
+        )
+
+    # INCREMENTAL UPDATES
+
+    def publish_changes(self, command, local_events):
+        """Mirror a change to the backend and apply the events it reports
+
+        Falls back to the locally derived events when no backend is running.
+        """
+        events = local_events
+        if self.backend.available():
+            reply = self.backend.request(command)
+            backend_events = self.backend.drain_events()
+            if self.reload_on_version(backend_events):
+                return
+            if reply and reply[0] == "OK" and backend_events:
+                events = backend_events
+        self.apply_events(events)
+
+    def reload_on_version(self, events):
+        """Re-read the map if the backend swapped in a new graph version
+
+        The backend's file watcher rebuilds from the map files without
+        per-change events, so the whole local model is loaded again; the
+        events after the last swap are then mirrored on top.
+        """
+        swaps = [i for i, ev in enumerate(events) if ev[0] == "VERSION"]
+        if not swaps:
+            return False
+
+        later = events[swaps[-1] + 1 :]
+
+        def on_loaded():
+            self.apply_model_events(later)
+            self.update_city_list()
+            self.draw_graph()
+
+        self.load_data(on_loaded=on_loaded)
+        return True
+
+    def apply_events(self, events):
+        """Update only the artists affected by change events"""
+        if self.lod_active():
+            for ev in events:
+                if ev[0] == "PATH_HIGHLIGHTED":
+                    self.lod_path = ev[1]
+                    self.lod_edges = None
+            self.draw_render_feed()
+            return
+
+        if self.scene is None or self.scene["tree"] or not self.scene["node_order"]:
+            path = [ev[1] for ev in events if ev[0] == "PATH_HIGHLIGHTED"]
+            self.draw_graph(highlight_path=path[-1] if path else None)
+            return
+
+        for ev in events:
+            kind = ev[0]
+            if kind == "PATH_HIGHLIGHTED":
+                self.scene_highlight_path(ev[1])
+            elif kind in ("ROAD_ADDED", "ROAD_UPDATED"):
+                self.scene_set_road(ev[1], ev[2], ev[3])
+            elif kind == "ROAD_REMOVED":
+                self.scene_remove_road(ev[1], ev[2])
+            elif kind == "CITY_ADDED":
+                self.scene_add_city(ev[1])
+            elif kind == "CITY_REMOVED":
+                self.scene_remove_city(ev[1])
+
+        self.canvas.draw_idle()
+
+    def path_edge_list(self, path):
+        return list(zip(path, path[1:])) if path else []
+
+    def scene_highlight_path(self, path):
+        """Restyle only the old and new path elements"""
+        old_path = self.scene["path"]
+        for edge in self.path_edge_list(old_path):
+            artist = self.scene["edges"].get(edge)
+            if artist is not None:
+                artist.set_color("#b0b2bf")
+                artist.set_linewidth(1.5)
+                artist.set_alpha(0.6)
+            label = self.scene["edge_labels"].get(edge)
+            if label is not None:
+                label.set_color("#94e2d5")
+
+        for edge in self.path_edge_list(path):
+            artist = self.scene["edges"].get(edge)
+            if artist is not None:
+                artist.set_color("#f9e2af")
+                artist.set_linewidth(5)
+                artist.set_alpha(0.95)
+            label = self.scene["edge_labels"].get(edge)
+            if label is not None:
+                label.set_color("#a6e3a1")
+
+        index = {node: i for i, node in enumerate(self.scene["node_order"])}
+        colors = self.scene["node_colors"]
+        sizes = self.scene["node_sizes"]
+        for node in old_path:
+            if node in index:
+                colors[index[node]] = "#89b4fa"
+                sizes[index[node]] = 3000
+        for node in path:
+            if node in index:
+                end = node == path[0] or node == path[-1]
+                colors[index[node]] = "#f9e2af" if end else "#f38ba8"
+                sizes[index[node]] = 3400
+        self.scene["nodes"].set_facecolor(colors)
+        self.scene["nodes"].set_sizes(sizes)
+        self.scene["path"] = list(path)
+
+    def scene_set_road(self, u, v, weight):
+        """Add one road artist, or relabel an existing one"""
+        if (u, v) in self.scene["edges"]:
+            self.scene["edge_labels"][(u, v)].set_text(str(int(weight)))
+            return
+        self.draw_edge_artists([(u, v)], False, bool(self.scene["path"]))
+        self.draw_edge_label((u, v), weight, False)
+
+    def scene_remove_road(self, u, v):
+        artist = self.scene["edges"].pop((u, v), None)
+        if artist is not None:
+            artist.remove()
+        label = self.scene["edge_labels"].pop((u, v), None)
+        if label is not None:
+            label.remove()
+
+    def scene_add_city(self, city_id):
+        self.scene["node_colors"].append("#89b4fa")
+        self.scene["node_sizes"].append(3000)
+        self.draw_node_artists()
+        labels = nx.draw_networkx_labels(
+            self.graph,
+            self.pos,
+            {city_id: self.cities[city_id]["name"]},
+            font_size=8,
+            font_color="#0F0E0E",
+            font_weight="bold",
+            ax=self.ax,
+        )
+        self.scene["labels"].update(labels)
+
+    def scene_remove_city(self, city_id):
+        for edge in [e for e in self.scene["edges"] if city_id in e]:
+            self.scene_remove_road(*edge)
+        label = self.scene["labels"].pop(city_id, None)
+        if label is not None:
+            label.remove()
+        if city_id in self.scene["node_order"]:
+            i = self.scene["node_order"].index(city_id)
+            del self.scene["node_colors"][i]
+            del self.scene["node_sizes"][i]
+        self.draw_node_artists()
+
+    # LEVEL-OF-DETAIL RENDERING
+
+    def full_extent(self):
+        """Bounding box of all cities with a small margin"""
+        xs = [c["x"] for c in self.cities.values()]
+        ys = [c["y"] for c in self.cities.values()]
+        pad_x = max((max(xs) - min(xs)) * 0.05, 1)
+        pad_y = max((max(ys) - min(ys)) * 0.05, 1)
+        return (min(xs) - pad_x, min(ys) - pad_y, max(xs) + pad_x, max(ys) + pad_y)
+
+    def draw_render_feed(self):
+        """Draw the backend's clustered feed for the current viewport"""
+        if self.view is None:
+            self.view = self.full_extent()
+        min_x, min_y, max_x, max_y = self.view
+
+        widget = self.canvas.get_tk_widget()
+        width_px = max(widget.winfo_width(), 100)
+        height_px = max(widget.winfo_height(), 100)
+
+        command = f"RENDER {min_x:.1f} {min_y:.1f} {max_x:.1f} {max_y:.1f} {width_px} {height_px}"
+        if self.lod_path:
+            command += " POLYLINE " + " ".join(str(c) for c in self.lod_path)
+        tokens = self.backend.request(command)
+        if tokens and tokens[:2] == ["BUSY", "loading"]:
+            # Backend is still loading the map; try again shortly
+            self.status_label.config(text="⏳ Backend loading map...")
+            self.root.after(500, self.draw_render_feed)
+            return
+        if not tokens or tokens[0] != "OK":
+            self.status_label.config(text="⚠️ Render feed unavailable")
+            return
+
+        num_clusters, num_edges, path_len = int(tokens[1]), int(tokens[2]), int(tokens[3])
+        values = tokens[4:]
+        clusters = [values[i * 4 : i * 4 + 4] for i in range(num_clusters)]
+        values = values[num_clusters * 4 :]
+        segments = [
+            ((float(v[0]), float(v[1])), (float(v[2]), float(v[3])))
+            for v in (values[i * 4 : i * 4 + 4] for i in range(num_edges))
+        ]
+        values = values[num_edges * 4 :]
+        path = decode_polyline(values[0]) if path_len and values else []
+
+        self.ax.clear()
+        if segments:
+            self.ax.add_collection(
+                LineCollection(segments, colors="#b0b2bf", linewidths=0.8, alpha=0.6)
+            )
+
+        if self.lod_edges:
+            tree = [(self.pos[u], self.pos[v]) for u, v in self.lod_edges]
+            self.ax.add_collection(
+                LineCollection(tree, colors="#f38ba8", linewidths=1.5, alpha=0.9)
             )
 
+        if clusters:
+            xs = [float(c[0]) for c in clusters]
+            ys = [float(c[1]) for c in clusters]
+            sizes = [min(20 + 6 * int(c[2]), 400) for c in clusters]
+            self.ax.scatter(xs, ys, s=sizes, c="#89b4fa", edgecolors="#ffffff", linewidths=0.5, zorder=3)
+
+            # Label single cities once the view is zoomed in enough
+            if len(clusters) <= 150:
+                for c in clusters:
+                    if c[2] == "1" and int(c[3]) in self.cities:
+                        self.ax.text(float(c[0]), float(c[1]), self.cities[int(c[3])]["name"],
+                                     fontsize=7, color="#cdd6f4", ha="center", va="bottom")
+
+        if path:
+            px = [p[0] for p in path]
+            py = [p[1] for p in path]
+            self.ax.plot(px, py, color="#f9e2af", linewidth=3, marker="o", markersize=5, zorder=4)
+            self.ax.scatter([px[0], px[-1]], [py[0], py[-1]], s=120, c="#f9e2af", zorder=5)
+
+        self.ax.set_xlim(min_x, max_x)
+        self.ax.set_ylim(min_y, max_y)
         self.ax.set_title(
-            "City Navigation Network",
+            f"City Navigation Network ({len(self.cities)} cities, {num_clusters} shown)",
             color="#cdd6f4",
             fontsize=16,
             pad=20,
             weight="bold",
         )
         self.ax.axis("off")
-        self.ax.margins(0.15)
         self.canvas.draw()
 
+    def lod_active(self):
+        return len(self.cities) > LOD_THRESHOLD and self.backend.available()
+
+    def on_scroll(self, event):
+        """Zoom around the cursor"""
+        if not self.lod_active() or event.xdata is None or self.view is None:
+            return
+        factor = 0.8 if event.button == "up" else 1.25
+        min_x, min_y, max_x, max_y = self.view
+        self.view = (
+            event.xdata - (event.xdata - min_x) * factor,
+            event.ydata - (event.ydata - min_y) * factor,
+            event.xdata + (max_x - event.xdata) * factor,
+            event.ydata + (max_y - event.ydata) * factor,
+        )
+        self.draw_render_feed()
+
+    def on_press(self, event):
+        if self.lod_active() and event.xdata is not None:
+            self.drag_start = (event.xdata, event.ydata)
+
+    def on_release(self, event):
+        """Pan by the drag distance"""
+        if not self.lod_active() or self.drag_start is None or event.xdata is None:
+            self.drag_start = None
+            return
+        dx = self.drag_start[0] - event.xdata
+        dy = self.drag_start[1] - event.ydata
+        self.drag_start = None
+        if dx == 0 and dy == 0:
+            return
+        min_x, min_y, max_x, max_y = self.view
+        self.view = (min_x + dx, min_y + dy, max_x + dx, max_y + dy)
+        self.draw_render_feed()
+
     def find_shortest_path_dijkstra(self):
         """Find shortest path using Dijkstra's algorithm"""
         dialog = MultiInputDialog(
@@ -1077,7 +1596,9 @@ class CityNavigationGUI:
             self.log_info(f"Time: {exec_time:.3f} ms")
             self.log_info(f"Complexity: O((V+E) log V)")
 
-            self.draw_graph(highlight_path=path)
+            self.publish_changes(
+                "HIGHLIGHT " + " ".join(map(str, path)), [("PATH_HIGHLIGHTED", path)]
+            )
             self.status_label.config(
                 text=f"Dijkstra | {exec_time:.2f} ms | {length} km"
             )
@@ -1152,7 +1673,9 @@ class CityNavigationGUI:
             self.log_info(f"Time: {exec_time:.3f} ms")
             self.log_info(f"Complexity: O(E)")
 
-            self.draw_graph(highlight_path=path)
+            self.publish_changes(
+                "HIGHLIGHT " + " ".join(map(str, path)), [("PATH_HIGHLIGHTED", path)]
+            )
             self.status_label.config(text=f"A* | {exec_time:.2f} ms | {int(length)} km")
             self.save_log("A*", source, dest, int(length))
 
@@ -1163,6 +1686,82 @@ class CityNavigationGUI:
             messagebox.showerror("Error", str(e))
             self.status_label.config(text="Error occurred")
 
+    def find_route_via(self):
+        """Find one route through ordered stops (A → B → C ...)"""
+        dialog = MultiInputDialog(
+            self.root,
+            "🧭 Route via Stops",
+            [{"label": "Stops in order (IDs or names, comma-separated):", "type": "str"}],
+        )
+        result = dialog.show()
+
+        if not result:
+            return
+
+        stops = []
+        for stop_input in (s.strip() for s in result[0].split(",")):
+            if not stop_input:
+                continue
+            stop = self.parse_city_input(stop_input)
+            if stop is None:
+                messagebox.showerror(
+                    "Error",
+                    f"City '{stop_input}' not found!\n\nPlease use exact ID or city name.",
+                )
+                return
+            stops.append(stop)
+
+        if len(stops) < 2:
+            messagebox.showerror("Error", "Enter at least two stops!")
+            return
+
+        try:
+            start_time = time.time()
+            if self.backend.available():
+                # One request; the backend chains the legs and reuses its workspace
+                command = f"ROUTE ASTAR {stops[0]} {stops[-1]}"
+                if len(stops) > 2:
+                    command += " VIA " + " ".join(map(str, stops[1:-1]))
+                tokens = self.backend.request(command)
+                self.reload_on_version(self.backend.drain_events())
+                if not tokens or tokens[0] == "NOPATH":
+                    raise nx.NetworkXNoPath()
+                if tokens[0] != "OK":
+                    raise RuntimeError(" ".join(tokens[1:]) if tokens else "backend error")
+                length, path_len = int(tokens[1]), int(tokens[2])
+                path = [int(t) for t in tokens[3 : 3 + path_len]]
+            else:
+                path, length = [stops[0]], 0
+                for a, b in zip(stops, stops[1:]):
+                    leg = nx.shortest_path(self.graph, a, b, weight="weight")
+                    length += nx.path_weight(self.graph, leg, weight="weight")
+                    path += leg[1:]
+            end_time = time.time()
+
+            exec_time = (end_time - start_time) * 1000
+
+            path_names = [self.cities[c]["name"] for c in path]
+            self.log_info(f"\n🧭 ROUTE VIA STOPS\n{'='*40}")
+            self.log_info(f"Stops: {' → '.join(self.cities[c]['name'] for c in stops)}")
+            self.log_info(f"Distance: {int(length)} km")
+            self.log_info(f"Path: {' → '.join(path_names)}")
+            self.log_info(f"Time: {exec_time:.3f} ms")
+
+            self.publish_changes(
+                "HIGHLIGHT " + " ".join(map(str, path)), [("PATH_HIGHLIGHTED", path)]
+            )
+            self.status_label.config(
+                text=f"Via {len(stops) - 2} stops | {exec_time:.2f} ms | {int(length)} km"
+            )
+            self.save_log("VIA", stops[0], stops[-1], int(length))
+
+        except nx.NetworkXNoPath:
+            messagebox.showerror("Error", "No route exists through these stops!")
+            self.status_label.config(text="Error: No path found")
+        except Exception as e:
+            messagebox.showerror("Error", str(e))
+            self.status_label.config(text="Error occurred")
+
     def bfs_traversal(self):
         """BFS traversal - shows actual tree edges used during traversal"""
         dialog = MultiInputDialog(
@@ -1331,7 +1930,7 @@ class CityNavigationGUI:
 
         self.log_info(f"✅ Added city: {name} (ID: {city_id})")
         self.update_city_list()
-        self.draw_graph()
+        self.publish_changes(f"ADDCITY {city_id} {x} {y} {name}", [("CITY_ADDED", city_id)])
         self.status_label.config(text=f"Added: {name}")
 
     def add_road(self):
@@ -1374,12 +1973,16 @@ class CityNavigationGUI:
             messagebox.showerror("Error", "Distance must be positive!")
             return
 
+        existed = self.graph.has_edge(from_id, to_id)
         self.graph.add_edge(from_id, to_id, weight=distance)
 
         from_name = self.cities[from_id]["name"]
         to_name = self.cities[to_id]["name"]
         self.log_info(f"✅ Road: {from_name} → {to_name} ({distance} km)")
-        self.draw_graph()
+        kind = "ROAD_UPDATED" if existed else "ROAD_ADDED"
+        self.publish_changes(
+            f"ADDROAD {from_id} {to_id} {distance}", [(kind, from_id, to_id, distance)]
+        )
         self.status_label.config(text=f"Added road: {from_name} → {to_name}")
 
     def delete_city(self):
@@ -1413,17 +2016,55 @@ class CityNavigationGUI:
 
         self.log_info(f"🗑️ Deleted: {name}")
         self.update_city_list()
-        self.draw_graph()
+        self.publish_changes(f"DELCITY {city_id}", [("CITY_REMOVED", city_id)])
         self.status_label.config(text=f"Deleted: {name}")
 
     def reload_data(self):
-        """Reload data"""
-        self.graph.clear()
-        self.cities.clear()
-        self.pos.clear()
-        self.load_data()
-        self.draw_graph()
-        self.status_label.config(text="Data reloaded")
+        """Reload data
+
+        With the backend running, only the differences it finds in the map
+        files are applied; otherwise the whole map is read again.
+        """
+        reply = self.backend.request("RELOAD") if self.backend.available() and self.cities else None
+        if not reply or reply[0] != "OK":
+            self.load_data(on_loaded=self.draw_graph)
+            return
+
+        events = self.backend.drain_events()
+        if self.reload_on_version(events):
+            return
+        self.apply_model_events(events)
+        summary = dict(t.split("=", 1) for t in reply[1:] if "=" in t)
+        self.log_info(
+            f"🔄 Reloaded changes: cities {summary['cities']}, roads {summary['roads']} "
+            f"({summary['ms']} ms)"
+        )
+        if any(ev[0] == "CITY_UPDATED" for ev in events):
+            self.draw_graph()  # Moved cities need a fresh layout
+        elif events:
+            self.apply_events(events)
+        self.update_city_list()
+        self.status_label.config(
+            text=f"✅ Reloaded {len(self.cities)} cities, {self.graph.number_of_edges()} roads"
+        )
+
+    def apply_model_events(self, events):
+        """Mirror backend change events into the local graph model"""
+        for ev in events:
+            kind = ev[0]
+            if kind in ("CITY_ADDED", "CITY_UPDATED"):
+                city_id, x, y, name = ev[1:5]
+                self.cities[city_id] = {"name": name, "x": x, "y": y}
+                self.graph.add_node(city_id, name=name, pos=(x, y))
+                self.pos[city_id] = (x, y)
+            elif kind == "CITY_REMOVED" and ev[1] in self.cities:
+                self.graph.remove_node(ev[1])
+                del self.cities[ev[1]]
+                del self.pos[ev[1]]
+            elif kind in ("ROAD_ADDED", "ROAD_UPDATED"):
+                self.graph.add_edge(ev[1], ev[2], weight=ev[3])
+            elif kind == "ROAD_REMOVED" and self.graph.has_edge(ev[1], ev[2]):
+                self.graph.remove_edge(ev[1], ev[2])
 
     def show_statistics(self):
         """Show statistics"""
@@ -1434,6 +2075,37 @@ class CityNavigationGUI:
             self.log_info("\n📊 No data loaded")
             return
 
+        tokens = self.backend.request("GRAPHSTATS") if self.backend.available() else None
+        if tokens and tokens[0] == "OK":
+            # One parallel pass in the backend instead of networkx
+            stats = dict(t.split("=", 1) for t in tokens[1:] if "=" in t)
+            min_w, max_w, avg_w = stats["weight"].split(",")
+            min_x, min_y, max_x, max_y = stats["bbox"].split(",")
+
+            def histogram(name):
+                counts = [int(c) for c in stats[name].split(",")]
+                return ", ".join(
+                    f"{b}{'+' if b == len(counts) - 1 else ''}: {c}"
+                    for b, c in enumerate(counts)
+                    if c
+                )
+
+            self.log_info(f"\n📊 STATISTICS\n{'='*40}")
+            self.log_info(f"Cities: {stats['cities']}")
+            self.log_info(f"Roads: {stats['roads']}")
+            self.log_info(f"Road length: {min_w}-{max_w} km (avg {avg_w})")
+            self.log_info(f"Bounding box: ({min_x}, {min_y}) - ({max_x}, {max_y})")
+            self.log_info(f"In-degrees: {histogram('indeg')}")
+            self.log_info(f"Out-degrees: {histogram('outdeg')}")
+            self.log_info(
+                f"Components: {stats['sccs']} (largest {stats['largest']} cities)"
+            )
+            self.log_info(
+                f"Self-loops: {stats['selfloops']}, duplicates: {stats['duplicates']}"
+            )
+            self.status_label.config(text=f"Statistics | {stats['ms']} ms")
+            return
+
         degrees = [d for n, d in self.graph.degree()]
         avg_degree = sum(degrees) / len(degrees) if degrees else 0
 
@@ -1492,4 +2164,5 @@ class CityNavigationGUI:
 if __name__ == "__main__":
     root = tk.Tk()
     app = CityNavigationGUI(root)
-    root.mainloop()
\ No newline at end of file
+    root.mainloop()
+    app.backend.close()
\ No newline at end of file
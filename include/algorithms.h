@@ -2,6 +2,80 @@
 #define ALGORITHMS_H
 
 #include "graph.h"
+#include <stdint.h>
+
+// Multi-source BFS lane width in 64-bit words per city
+// 1 = 64 sources per pass, 4 = 256 sources per pass (one AVX2 register)
+#ifndef MSBFS_WORDS
+#define MSBFS_WORDS 4
+#endif
+#define MSBFS_BATCH (64 * MSBFS_WORDS)
+
+// Point-to-point searches searchBatch advances in lockstep on one thread
+#ifndef SEARCH_BATCH_WIDTH
+#define SEARCH_BATCH_WIDTH 8
+#endif
+
+// Software prefetch distance, in edges, of the search and multi-source BFS
+// relaxation loops; 0 builds them without prefetches
+#ifndef SEARCH_PREFETCH_DISTANCE
+#define SEARCH_PREFETCH_DISTANCE 2
+#endif
+
+// SEARCH CONTROL
+
+// Default number of relaxations between deadline checks
+#define SEARCH_CHECK_INTERVAL 256
+
+/**
+ * Outcome of a controlled search
+ */
+typedef enum SearchStatus {
+    SEARCH_OK = 0,          // Completed normally
+    SEARCH_NO_PATH,         // Completed, destination unreachable
+    SEARCH_DEADLINE,        // Stopped early, deadline passed
+    SEARCH_CANCELLED        // Stopped early, cancel was requested
+} SearchStatus;
+
+/**
+ * Deadline and cancellation token for search routines
+ * Pass NULL wherever a SearchControl* is accepted to run unbounded
+ */
+typedef struct SearchControl {
+    double deadlineMs;          // Absolute deadline on currentTimeMs() clock, 0 = none
+    volatile int cancelled;     // Set (e.g. from another thread) to stop the search
+    int checkInterval;          // Relaxations between deadline checks
+    int work;                   // Relaxations since the last check
+    SearchStatus status;        // Outcome of the last search using this control
+} SearchControl;
+
+/**
+ * Initialize a search control
+ * @param ctl: Pointer to control
+ * @param budgetMs: Time budget from now in milliseconds (<= 0 = no deadline)
+ */
+void initSearchControl(SearchControl* ctl, double budgetMs);
+
+/**
+ * Request cancellation of any search using this control
+ * @param ctl: Pointer to control
+ */
+void cancelSearch(SearchControl* ctl);
+
+/**
+ * Account for work and check whether the search must stop
+ * Reads the cancel flag on every call, the clock every checkInterval relaxations
+ * @param ctl: Pointer to control (NULL never stops)
+ * @param work: Relaxations performed since the previous call
+ * @return: 1 if the search must stop (status is set), 0 otherwise
+ */
+int searchShouldStop(SearchControl* ctl, int work);
+
+/**
+ * Monotonic wall clock
+ * @return: Current time in milliseconds
+ */
+double currentTimeMs(void);
 
 //MIN-HEAP DATA STRUCTURES
 
@@ -10,9 +84,9 @@
  * Used in Dijkstra's and A* algorithms
  */
 typedef struct HeapNode {
-    int cityID;         // City identifier
-    int distance;       // Distance from source (g-score)
-    int fScore;         // Total score for A* (f = g + h)
+    int cityID;         // City index in g->cities (heap key)
+    dist_t distance;    // Distance from source (g-score)
+    dist_t fScore;      // Total score for A* (f = g + h)
 } HeapNode;
 
 /**
@@ -48,7 +122,7 @@ void freeMinHeap(MinHeap* h);
  * @param distance: Distance value
  * @param fScore: F-score for A* (use same as distance for Dijkstra)
  */
-void insertHeap(MinHeap* h, int cityID, int distance, int fScore);
+void insertHeap(MinHeap* h, int cityID, dist_t distance, dist_t fScore);
 
 /**
  * Extract minimum element from heap
@@ -64,7 +138,7 @@ HeapNode extractMin(MinHeap* h);
  * @param newDist: New distance value
  * @param newFScore: New f-score value
  */
-void decreaseKey(MinHeap* h, int cityID, int newDist, int newFScore);
+void decreaseKey(MinHeap* h, int cityID, dist_t newDist, dist_t newFScore);
 
 /**
  * Check if heap is empty
@@ -76,22 +150,49 @@ int isHeapEmpty(MinHeap* h);
 //  PATH RESULT STRUCTURE 
 /**
  * Structure to store path result
- * Contains the path and total distance
+ * Contains the total distance and path length. Searches return it packed:
+ * the route is kept as city indices (pathLength ints, not the search's
+ * parent array) until getPath or unpackPath maps them to IDs, so
+ * distance-only callers never build the ID array.
  */
 typedef struct PathResult {
-    int* path;              // Array of city IDs in path order
-    int pathLength;         // Number of cities in path
-    int totalDistance;      // Total distance of path
+    int* path;              // Array of city IDs in path order, NULL while packed
+    int pathLength;         // Number of cities in path (known while packed)
+    dist_t totalDistance;   // Total distance of path
     int pathCapacity;       // Allocated capacity for path array
+    int* indices;           // Packed: city index per path position (owned), or NULL
+    Graph* graph;           // Packed: graph the indices refer to
+    unsigned long graphVersion; // Packed: graph version at search time
+    int numSegments;        // Via routes: number of legs, else 0
+    int* segmentEnds;       // Via routes: path index of each leg's last city
+    dist_t* segmentDistances; // Via routes: distance of each leg
 } PathResult;
 
 /**
  * Create a new PathResult structure
- * @param capacity: Initial capacity
+ * @param capacity: Initial capacity (0 allocates no path array)
  * @return: Pointer to PathResult, or NULL on failure
  */
 PathResult* createPathResult(int capacity);
 
+/**
+ * Copy the path's city IDs into a caller buffer
+ * Works on packed and unpacked results without allocating
+ * @param pr: Pointer to PathResult
+ * @param buffer: Receives pathLength city IDs in path order
+ * @param capacity: Buffer size
+ * @return: Number of IDs written, or -1 if the buffer is too small or the
+ *          graph changed since a packed search
+ */
+int unpackPath(const PathResult* pr, int* buffer, int capacity);
+
+/**
+ * Materialise the path into pr->path (once) and return it
+ * @param pr: Pointer to PathResult
+ * @return: City IDs in path order, or NULL if empty or unavailable
+ */
+const int* getPath(PathResult* pr);
+
 /**
  * Free PathResult memory
  * @param pr: Pointer to PathResult
@@ -118,24 +219,207 @@ void reversePath(PathResult* pr);
  * Explores graph level by level
  * @param g: Pointer to graph
  * @param startCityID: Starting city ID
+ * @param ctl: Deadline/cancellation control, or NULL
  */
-void BFS(Graph* g, int startCityID);
+void BFS(Graph* g, int startCityID, SearchControl* ctl);
 
 /**
  * Depth-First Search traversal
  * Explores graph depth-wise using recursion
  * @param g: Pointer to graph
  * @param startCityID: Starting city ID
+ * @param ctl: Deadline/cancellation control, or NULL
  */
-void DFS(Graph* g, int startCityID);
+void DFS(Graph* g, int startCityID, SearchControl* ctl);
 
 /**
  * DFS utility function (recursive helper)
  * @param g: Pointer to graph
+ * @param csr: CSR snapshot of g
  * @param cityIndex: Current city index in array
  * @param visited: Array tracking visited cities
+ * @param ctl: Deadline/cancellation control, or NULL
+ */
+void DFSUtil(Graph* g, const CSRGraph* csr, int cityIndex, int* visited, SearchControl* ctl);
+
+/**
+ * Bit-parallel multi-source BFS (hop distances)
+ * Runs up to MSBFS_BATCH sources per pass, using one bit per source
+ * in the visited/frontier masks of every city
+ * @param g: Pointer to graph
+ * @param sourceIDs: Array of source city IDs
+ * @param numSources: Number of sources
+ * @param hopDist: Output, numSources x numCities row-major hop counts
+ *                 indexed by city array index (-1 if unreachable)
+ * @param ctl: Deadline/cancellation control, or NULL
+ * @return: 1 on success, 0 on failure or when stopped early
+ */
+int multiSourceBFS(Graph* g, const int* sourceIDs, int numSources, int* hopDist,
+                   SearchControl* ctl);
+
+// SEARCH KERNELS
+/**
+ * Counters filled by searches run with SearchOptions.stats set
+ */
+typedef struct SearchStats {
+    long settled;           // Cities taken off the heap
+    long relaxed;           // Roads examined
+} SearchStats;
+
+/**
+ * Road filter for searches
+ * Reverse searches pass the cities in search order (toIndex is the road's
+ * source) but always the forward edge index
+ * @param fromIndex: City index the road leaves
+ * @param toIndex: City index the road enters
+ * @param edgeIndex: Road index in the graph's CSR
+ * @param userData: SearchOptions.filterData
+ * @return: 1 if the road may be used, 0 to skip it
+ */
+typedef int (*EdgeFilter)(int fromIndex, int toIndex, int edgeIndex, void* userData);
+
+/**
+ * Search variant selection
+ * Every combination of heuristic / early exit / filter / stats is compiled
+ * as its own kernel, so unused options cost nothing in the inner loop
+ */
+typedef struct SearchOptions {
+    double epsilon;         // 0 = Dijkstra, >= 1.0 = A* with f = g + epsilon * h
+    int fullTree;           // 1 = settle every reachable city instead of stopping at the target
+    int reverse;            // 1 = follow roads backwards (shortestPathTree only)
+    EdgeFilter filter;      // Road filter, or NULL
+    void* filterData;       // Passed through to filter
+    SearchStats* stats;     // Counters to add to, or NULL
+} SearchOptions;
+
+/**
+ * Fill options with plain Dijkstra defaults
+ * @param opts: Pointer to options
+ */
+void initSearchOptions(SearchOptions* opts);
+
+/**
+ * Point-to-point shortest path with the kernel variant chosen by opts
+ * @param g: Pointer to graph
+ * @param sourceCityID: Source city ID
+ * @param destCityID: Destination city ID
+ * @param opts: Search options
+ * @param ctl: Deadline/cancellation control, or NULL
+ * @return: PathResult with path (empty if none or stopped), or NULL on failure
+ */
+PathResult* searchPath(Graph* g, int sourceCityID, int destCityID, const SearchOptions* opts,
+                       SearchControl* ctl);
+
+/**
+ * Route through ordered waypoints
+ * Legs share one search workspace. A waypoint that starts several legs
+ * (e.g. A->B->A->C) gets a single one-to-many Dijkstra search, resumed
+ * for each of its targets; other legs use opts as a point-to-point search.
+ * @param g: Pointer to graph
+ * @param waypointIDs: City IDs in visiting order (first = start, last = end)
+ * @param numWaypoints: Number of waypoints (>= 2)
+ * @param opts: Search options (fullTree ignored), or NULL for A*
+ * @param ctl: Deadline/cancellation control shared by all legs, or NULL
+ * @return: One concatenated, unpacked PathResult with segmentEnds and
+ *          segmentDistances per leg (empty if any leg has no path or the
+ *          search stopped), or NULL on failure
+ */
+PathResult* routeVia(Graph* g, const int* waypointIDs, int numWaypoints,
+                     const SearchOptions* opts, SearchControl* ctl);
+
+/**
+ * Dijkstra shortest-path tree from one source to every reachable city
+ * One tree answers a whole row of a distance matrix; with opts->reverse it
+ * runs on the transposed CSR and answers a column (distances *to* the source)
+ * @param g: Pointer to graph
+ * @param sourceCityID: Source city ID
+ * @param opts: Filter, stats and reverse options (epsilon/fullTree ignored), or NULL
+ * @param dist: Output, numCities distances by city index (INF if unreachable)
+ * @param parent: Output, numCities parent city indices (-1 for none); in a
+ *                reverse tree, the next city on the way to the source
+ * @param ctl: Deadline/cancellation control, or NULL
+ * @return: 1 on success, 0 on failure or when stopped early
+ */
+int shortestPathTree(Graph* g, int sourceCityID, const SearchOptions* opts,
+                     dist_t* dist, int* parent, SearchControl* ctl);
+
+/**
+ * Answer a batch of point-to-point queries on one thread, interleaved
+ * Up to SEARCH_BATCH_WIDTH searches advance in lockstep, one settled city
+ * each per round, in stages that first prefetch what every search needs
+ * next and then use it, so the cache misses of different searches
+ * overlap. Results match searchPath with the same options.
+ * @param g: Pointer to graph
+ * @param sourceIDs: Source city ID per query
+ * @param destIDs: Destination city ID per query
+ * @param numQueries: Number of queries
+ * @param opts: Epsilon, filter and stats options (fullTree/reverse ignored)
+ * @param distances: Output, distance per query (INF if unreachable or unknown)
+ * @param paths: Output, packed PathResult per query (empty if none), or NULL
+ *               for distances only; free each with freePathResult
+ * @param ctl: Deadline/cancellation control for the whole batch, or NULL
+ * @return: 1 on success, 0 on failure or when stopped early
+ */
+int searchBatch(Graph* g, const int* sourceIDs, const int* destIDs, int numQueries,
+                const SearchOptions* opts, dist_t* distances, PathResult** paths,
+                SearchControl* ctl);
+
+// AVOID SETS
+/**
+ * Cities and roads a route must not use (closures, user preferences)
+ * Bitsets over city indices and CSR road indices, checked in the search
+ * loop through the edge filter; the graph itself is never modified.
+ * Indices are only valid for the graph version the set was built on.
+ */
+typedef struct AvoidSet {
+    uint64_t* cities;           // Bit per city index: never enter
+    uint64_t* roads;            // Bit per CSR road index: never take
+    int numCities;              // City bits in use
+    int numRoads;               // Road bits in use
+    unsigned long graphVersion; // Graph version the indices refer to
+} AvoidSet;
+
+/**
+ * Create an empty avoid set for the graph's current version
+ * @param g: Pointer to graph
+ * @return: Pointer to new set, or NULL on failure
+ */
+AvoidSet* createAvoidSet(Graph* g);
+
+/**
+ * Free an avoid set
+ * @param avoid: Pointer to set
+ */
+void freeAvoidSet(AvoidSet* avoid);
+
+/**
+ * Avoid a city: routes may start there but never pass through or end there
+ * @param avoid: Pointer to set
+ * @param g: Pointer to graph
+ * @param cityID: City to avoid
+ * @return: 1 on success, 0 if the city does not exist
+ */
+int avoidCity(AvoidSet* avoid, Graph* g, int cityID);
+
+/**
+ * Avoid every road from one city to another (one direction)
+ * @param avoid: Pointer to set
+ * @param g: Pointer to graph
+ * @param fromCityID: Road source
+ * @param toCityID: Road destination
+ * @return: 1 on success, 0 if no such road exists
  */
-void DFSUtil(Graph* g, int cityIndex, int* visited);
+int avoidRoad(AvoidSet* avoid, Graph* g, int fromCityID, int toCityID);
+
+/**
+ * Route searches using opts around the avoid set
+ * Selects the filtered kernel variants; pass NULL to clear
+ * @param opts: Search options
+ * @param avoid: Avoid set (must outlive the searches), or NULL
+ * @param g: Graph the searches will run on
+ * @return: 1 on success, 0 if the graph changed since the set was built
+ */
+int setAvoidFilter(SearchOptions* opts, const AvoidSet* avoid, Graph* g);
 
 // SHORTEST PATH ALGORITHMS 
 
@@ -145,9 +429,10 @@ void DFSUtil(Graph* g, int cityIndex, int* visited);
  * @param g: Pointer to graph
  * @param sourceCityID: Source city ID
  * @param destCityID: Destination city ID
- * @return: PathResult with shortest path, or NULL on failure
+ * @param ctl: Deadline/cancellation control, or NULL
+ * @return: PathResult with shortest path (empty if none or stopped), or NULL on failure
  */
-PathResult* dijkstra(Graph* g, int sourceCityID, int destCityID);
+PathResult* dijkstra(Graph* g, int sourceCityID, int destCityID, SearchControl* ctl);
 
 /**
  * A* shortest path algorithm
@@ -155,9 +440,54 @@ PathResult* dijkstra(Graph* g, int sourceCityID, int destCityID);
  * @param g: Pointer to graph
  * @param sourceCityID: Source city ID
  * @param destCityID: Destination city ID
- * @return: PathResult with shortest path, or NULL on failure
+ * @param ctl: Deadline/cancellation control, or NULL
+ * @return: PathResult with shortest path (empty if none or stopped), or NULL on failure
+ */
+PathResult* astar(Graph* g, int sourceCityID, int destCityID, SearchControl* ctl);
+
+/**
+ * Weighted A* (bounded-suboptimal)
+ * Inflates the heuristic: f = g + epsilon * h
+ * Returned distance is at most epsilon times the optimum (for an admissible h)
+ * @param g: Pointer to graph
+ * @param sourceCityID: Source city ID
+ * @param destCityID: Destination city ID
+ * @param epsilon: Heuristic weight, >= 1.0 (1.0 = plain A*)
+ * @param ctl: Deadline/cancellation control, or NULL
+ * @return: PathResult with path (empty if none or stopped), or NULL on failure
+ */
+PathResult* astarWeighted(Graph* g, int sourceCityID, int destCityID, double epsilon,
+                          SearchControl* ctl);
+
+/**
+ * Callback for each improved anytime solution
+ * The PathResult is owned by the search and only valid during the call
+ * @param pr: Improved path
+ * @param epsilon: Suboptimality bound of this path
+ * @param userData: Caller context
+ */
+typedef void (*AnytimePathCallback)(PathResult* pr, double epsilon, void* userData);
+
+/**
+ * Anytime repairing A* (ARA*)
+ * Starts with an inflated heuristic and lowers epsilon pass by pass,
+ * reusing previous search effort, until epsilon reaches 1.0 or the
+ * deadline passes. The first pass always runs to completion.
+ * @param g: Pointer to graph
+ * @param sourceCityID: Source city ID
+ * @param destCityID: Destination city ID
+ * @param epsilon: Initial heuristic weight (>= 1.0)
+ * @param epsilonStep: Amount epsilon decreases per pass
+ * @param deadlineMs: Time budget in milliseconds
+ * @param onImprove: Called for each improved path (may be NULL)
+ * @param userData: Passed through to onImprove
+ * @param ctl: Hard stop/cancellation control (applies to every pass), or NULL
+ * @return: Best path found, or NULL on failure
  */
-PathResult* astar(Graph* g, int sourceCityID, int destCityID);
+PathResult* astarAnytime(Graph* g, int sourceCityID, int destCityID, double epsilon,
+                         double epsilonStep, double deadlineMs,
+                         AnytimePathCallback onImprove, void* userData,
+                         SearchControl* ctl);
 
 /**
  * Heuristic function for A* algorithm
@@ -169,6 +499,56 @@ PathResult* astar(Graph* g, int sourceCityID, int destCityID);
  */
 int heuristic(Graph* g, int cityIndex1, int cityIndex2);
 
+// GRAPH STATISTICS
+#define STATS_DEGREE_BUCKETS 16     // Degrees 0..14; the last bucket counts 15 and up
+#define STATS_WEIGHT_BUCKETS 32     // Bucket 0 counts weight 0, bucket b > 0 weights in [2^(b-1), 2^b)
+#define STATS_MAX_THREADS 16
+#ifndef STATS_MIN_CITIES_PER_THREAD
+#define STATS_MIN_CITIES_PER_THREAD 16384  // Smaller graphs are scanned by fewer threads
+#endif
+
+/**
+ * Structural summary of a graph, from graphStats
+ * Two-way roads count as two directed roads throughout
+ */
+typedef struct GraphStats {
+    int numCities;
+    int numEdges;
+    long inDegree[STATS_DEGREE_BUCKETS];    // Cities per in-degree
+    long outDegree[STATS_DEGREE_BUCKETS];   // Cities per out-degree
+    int maxInDegree;
+    int maxOutDegree;
+    long weights[STATS_WEIGHT_BUCKETS];     // Roads per distance bucket
+    int minWeight;              // 0 if there are no roads
+    int maxWeight;
+    long long totalWeight;
+    long selfLoops;             // Roads from a city to itself
+    long duplicates;            // Roads repeating an earlier from -> to pair
+    int numComponents;          // Strongly connected components
+    int largestComponent;       // Cities in the largest component
+    int minX, minY;             // Coordinate bounding box (0 if empty)
+    int maxX, maxY;
+    int threads;                // Threads that scanned the CSR
+    double elapsedMs;
+} GraphStats;
+
+/**
+ * Compute graph statistics in one parallel pass over the CSR
+ * City ranges are scanned by worker threads while the calling thread
+ * counts strongly connected components
+ * @param g: Pointer to graph (not changed during the call)
+ * @param stats: Output statistics
+ * @param numThreads: Scanning threads, 0 = one per CPU (capped by graph size)
+ * @return: 1 on success, 0 on failure
+ */
+int graphStats(Graph* g, GraphStats* stats, int numThreads);
+
+/**
+ * Print a statistics report
+ * @param stats: Statistics from graphStats
+ */
+void displayGraphStats(const GraphStats* stats);
+
 //  DISPLAY FUNCTIONS
 
 /**
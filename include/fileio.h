@@ -2,17 +2,120 @@
 #define FILEIO_H
 
 #include "graph.h"
+#include <pthread.h>
 
 // FILE PATH CONSTANTS 
 #define CITIES_FILE "cities.txt"
 #define ROADS_FILE "roads.txt"
 #define LOGS_FILE "logs.txt"
+#define REJECTS_FILE "rejects.txt"      // Sample of rows rejected by the last import
+
+#define LOAD_PROGRESS_INTERVAL 65536    // Lines between progress reports
+#define IMPORT_REJECT_SAMPLE 1000       // Rejected rows copied to REJECTS_FILE per load
+#define FINGERPRINT_BLOCK_SIZE (1 << 20) // Bytes per fingerprint block hash
+
+// IMPORT VALIDATION
+/**
+ * Why an import row was rejected
+ * Rejected rows are counted and sampled, never loaded; a duplicate key
+ * keeps the first row
+ */
+typedef enum ImportIssue {
+    ISSUE_PARSE,            // Not a well-formed CSV row (or longer than the row buffer)
+    ISSUE_UNKNOWN_CITY,     // Road endpoint missing from the cities file
+    ISSUE_BAD_DISTANCE,     // Road distance not in 1..ROAD_MAX_DISTANCE
+    ISSUE_DUPLICATE,        // Same city ID or road as an earlier row, same data
+    ISSUE_CONFLICT,         // Same city ID or road as an earlier row, different data
+    NUM_IMPORT_ISSUES
+} ImportIssue;
+
+// INCREMENTAL RELOAD TYPES
+/**
+ * Fingerprint of one map file as of the last reload
+ * A matching size and mtime skips the file unread (unless the file was
+ * modified in the second the fingerprint was taken); otherwise matching
+ * block hashes show a rewrite that left the content as it was
+ */
+typedef struct FileFingerprint {
+    long long size;                 // Bytes, -1 until first taken
+    long long mtimeNs;              // Modification time, nanoseconds
+    long long takenAt;              // Wall-clock seconds when taken
+    int numBlocks;
+    unsigned long long* blockHashes;    // FNV-1a per FINGERPRINT_BLOCK_SIZE bytes
+} FileFingerprint;
+
+/**
+ * Reload state for a pair of map files
+ */
+typedef struct MapFingerprint {
+    FileFingerprint cities;
+    FileFingerprint roads;
+    long unknownCityRoads;      // Roads rejected for a missing endpoint by the
+                                // last roads pass, -1 if unknown
+} MapFingerprint;
+
+/**
+ * What a reload found and applied
+ */
+typedef struct ReloadSummary {
+    int filesRead;              // Files diffed against the graph (0-2)
+    int blocksChanged;          // Fingerprint blocks that differed
+    long citiesAdded;
+    long citiesRemoved;
+    long citiesChanged;         // Renamed or moved
+    long roadsAdded;
+    long roadsRemoved;
+    long roadsChanged;          // New distance
+    long rowsRejected;          // Rows quarantined by import validation
+    double elapsedMs;
+} ReloadSummary;
+
+// BACKGROUND LOADING TYPES
+/**
+ * Stages of a background load, in order
+ * From LOAD_INDICES on, the base graph is complete and may be queried;
+ * LOAD_READY adds the cached CSR used by A*, BFS and rendering
+ */
+typedef enum LoadStage {
+    LOAD_CITIES,        // Reading cities file
+    LOAD_ROADS,         // Reading roads file
+    LOAD_INDICES,       // Base graph ready, building accelerated structures
+    LOAD_READY,         // Fully loaded
+    LOAD_FAILED         // A file could not be read; the graph holds what was loaded
+} LoadStage;
+
+/**
+ * Snapshot of load progress
+ */
+typedef struct LoadProgress {
+    LoadStage stage;
+    long citiesLoaded;
+    long roadsLoaded;
+    long rowsRejected;      // Rows quarantined by import validation
+    double elapsedMs;       // Since the load started
+} LoadProgress;
+
+/**
+ * Progress callback, called from the loader thread at each stage change
+ * and every LOAD_PROGRESS_INTERVAL lines. During LOAD_CITIES/LOAD_ROADS
+ * the loader holds the graph lock, so the callback must not take it.
+ * @param progress: Current progress
+ * @param userData: Callback context
+ */
+typedef void (*LoadProgressCallback)(const LoadProgress* progress, void* userData);
+
+/**
+ * Background load handle (opaque)
+ */
+typedef struct GraphLoader GraphLoader;
 
 // FILE I/O OPERATIONS 
 
 /**
  * Load graph from CSV files
- * Reads cities.txt and roads.txt to populate graph
+ * Reads cities.txt and roads.txt to populate graph, then caches the CSR
+ * and prints a graphStats sanity check. Invalid rows are skipped, counted
+ * per ImportIssue in one summary line per file and sampled to REJECTS_FILE
  * @param g: Pointer to graph
  * @param citiesFile: Path to cities file
  * @param roadsFile: Path to roads file
@@ -30,6 +133,96 @@ int loadGraphFromFiles(Graph* g, const char* citiesFile, const char* roadsFile);
  */
 int saveGraphToFiles(Graph* g, const char* citiesFile, const char* roadsFile);
 
+// INCREMENTAL RELOAD
+/**
+ * Prepare an empty fingerprint (the first reload diffs both files)
+ * @param fp: Pointer to fingerprint
+ */
+void initMapFingerprint(MapFingerprint* fp);
+
+/**
+ * Free a fingerprint's block hashes
+ * @param fp: Pointer to fingerprint
+ */
+void freeMapFingerprint(MapFingerprint* fp);
+
+/**
+ * Fingerprint both map files as they are now, for a graph just loaded
+ * from them (the next reload diffs only what changes after this)
+ * @param fp: Pointer to fingerprint, replaced on success
+ * @param citiesFile: Path to cities file
+ * @param roadsFile: Path to roads file
+ * @return: 1 on success, 0 if a file cannot be read (fp is then unchanged)
+ */
+int takeMapFingerprint(MapFingerprint* fp, const char* citiesFile, const char* roadsFile);
+
+/**
+ * Bring the graph in line with changed map files
+ * Files whose fingerprint still matches are skipped. Changed files are
+ * streamed through the same validation as a full load and compared with
+ * the graph; only the added, removed and changed cities and roads are
+ * applied, in one applyGraphMutations batch. The graph is untouched if a
+ * file cannot be read. Also diffs an unchanged roads file when new cities
+ * may have made rejected rows valid.
+ * @param g: Pointer to graph (normally loaded from the same files)
+ * @param citiesFile: Path to cities file
+ * @param roadsFile: Path to roads file
+ * @param fp: Fingerprint from the previous reload, updated on success
+ * @param summary: Receives what changed (may be NULL)
+ * @return: 1 on success, 0 on failure
+ */
+int reloadGraphFromFiles(Graph* g, const char* citiesFile, const char* roadsFile,
+                         MapFingerprint* fp, ReloadSummary* summary);
+
+// BACKGROUND LOADING
+/**
+ * Start loading a graph on a background thread
+ * Stages: cities, roads (graph lock held for writing), then the CSR cache
+ * (graph lock held for reading, attached only if the graph did not change
+ * meanwhile) and the graphStats sanity check. Without a lock the caller must not touch the graph before
+ * LOAD_INDICES, nor change it before LOAD_READY.
+ * @param g: Pointer to graph (normally empty)
+ * @param citiesFile: Path to cities file
+ * @param roadsFile: Path to roads file
+ * @param graphLock: Lock guarding the graph, or NULL
+ * @param callback: Progress callback, or NULL
+ * @param userData: Passed to callback
+ * @return: Loader handle, or NULL if the thread could not be started
+ */
+GraphLoader* startGraphLoad(Graph* g, const char* citiesFile, const char* roadsFile,
+                            pthread_rwlock_t* graphLock, LoadProgressCallback callback,
+                            void* userData);
+
+/**
+ * Read current progress
+ * @param loader: Loader handle
+ * @param progress: Receives a snapshot (may be NULL)
+ * @return: Current stage
+ */
+LoadStage getLoadProgress(GraphLoader* loader, LoadProgress* progress);
+
+/**
+ * Block until the load reaches a stage
+ * @param loader: Loader handle
+ * @param stage: Stage to wait for (e.g. LOAD_INDICES for a queryable graph)
+ * @return: 1 if reached, 0 if the load failed first
+ */
+int waitGraphLoad(GraphLoader* loader, LoadStage stage);
+
+/**
+ * Stop a load still in progress, join the thread and free the handle
+ * @param loader: Loader handle
+ * @return: 1 if the load completed, 0 if it failed or was stopped
+ */
+int finishGraphLoad(GraphLoader* loader);
+
+/**
+ * Printable stage name
+ * @param stage: Load stage
+ * @return: Lower-case name ("cities", "roads", ...)
+ */
+const char* loadStageName(LoadStage stage);
+
 // LOGGING OPERATIONS 
 /**
  * Log a general operation to logs.txt
@@ -45,7 +238,7 @@ void logOperation(const char* operation);
  * @param dest: Destination city name
  * @param distance: Total distance
  */
-void logPathQuery(const char* source, const char* dest, int distance);
+void logPathQuery(const char* source, const char* dest, dist_t distance);
 
 // UTILITY FUNCTIONS 
 
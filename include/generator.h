@@ -0,0 +1,48 @@
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+// GENERATOR CONSTANTS
+#define GENERATOR_MIN_SPACING 100   // Default minimum distance between cities
+#define GENERATOR_NEIGHBOURS 3      // Default nearest-neighbour roads per city
+#define GENERATOR_MAX_NEIGHBOURS 8  // Upper bound for neighbours
+#define GENERATOR_ATTEMPTS 12       // Poisson-disc candidates per active city
+#define GENERATOR_DETOUR 0.25       // Max extra road length over straight line (25%)
+
+// DATA STRUCTURES
+/**
+ * Random map generator settings
+ */
+typedef struct GeneratorConfig {
+    int numCities;              // Cities to place
+    int minSpacing;             // Poisson-disc radius in map units
+    int neighbours;             // Roads to the k nearest cities, on top of the spanning tree
+    unsigned long long seed;    // Random seed (same seed, same map)
+} GeneratorConfig;
+
+// GENERATOR OPERATIONS
+/**
+ * Fill a config with defaults for numCities cities
+ * @param config: Pointer to config
+ * @param numCities: Cities to place
+ */
+void initGeneratorConfig(GeneratorConfig* config, int numCities);
+
+/**
+ * Generate a random connected map and write it as cities/roads CSV files
+ *
+ * Cities are placed by Poisson-disc sampling on a background grid, growing
+ * outward from the centre, so no two cities are closer than minSpacing.
+ * Each city is joined to the city it was sampled from (a spanning tree, so
+ * the map is connected) and to its k nearest neighbours. Roads are written
+ * in both directions with a length of 1.0-1.25x the straight-line distance,
+ * which keeps the A* heuristic admissible.
+ * Runs in O(n log n); a 1M-city map takes a few seconds.
+ *
+ * @param config: Generator settings
+ * @param citiesFile: Path to cities file
+ * @param roadsFile: Path to roads file
+ * @return: Number of cities written, or 0 on failure
+ */
+int generateRandomMap(const GeneratorConfig* config, const char* citiesFile, const char* roadsFile);
+
+#endif // GENERATOR_H
@@ -4,20 +4,64 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 
 // CONSTANTS 
 #define MAX_CITY_NAME 50
-#define INF 999999
+#define EDGE_SLAB_EDGES 1024    // Edges per slab allocation
+
+// DISTANCES
+/**
+ * Path distance type, chosen at compile time
+ * Road weights stay int in the graph to keep it small; only sums along a
+ * path (search scores, path totals) use dist_t. Build with -DDIST_64BIT
+ * when fine-grained weights (e.g. metres) can add up past 2^31.
+ */
+#ifdef DIST_64BIT
+typedef long long dist_t;
+#define DIST_MAX LLONG_MAX
+#define DIST_FMT "%lld"
+#else
+typedef int dist_t;
+#define DIST_MAX INT_MAX
+#define DIST_FMT "%d"
+#endif
+
+// Unreachable sentinel, override with -DINF=<value>
+#ifndef INF
+#define INF DIST_MAX
+#endif
+
+/**
+ * Saturating distance add: never wraps past INF
+ * @param a: Distance so far (<= INF)
+ * @param b: Non-negative distance to add
+ * @return: a + b, or INF if the sum would reach it
+ */
+static inline dist_t distAdd(dist_t a, dist_t b) {
+    return a >= INF - b ? INF : a + b;
+}
 
 // DATA STRUCTURES
+// Edge direction flags
+#define ROAD_TWO_WAY 0x01   // Also runs from destCityID back to the owning city
+#define ROAD_SEEN 0x02      // Scratch marks for whole-graph passes (reload diff),
+#define ROAD_SEEN_BACK 0x04 // cleared before the pass returns
+#define ROAD_FLAG_BITS 3
+#define ROAD_MAX_DISTANCE ((1 << (32 - ROAD_FLAG_BITS)) - 1)  // Longest road an Edge can hold
+
 /**
  * Edge node in adjacency list
- * Represents a road from one city to another
+ * Represents a road from one city to another. A two-way road is stored
+ * once, in the list of one of its ends; the CSR snapshot expands it into
+ * both directions, so searches never see the flag. The flags share the
+ * distance's word, keeping an edge at 16 bytes on 64-bit targets.
  */
 typedef struct Edge {
-    int destCityID;         // Destination city ID
-    int distance;           // Distance in kilometers
-    struct Edge* next;      // Pointer to next edge in list
+    int destCityID;                                 // Destination city ID
+    unsigned int distance : 32 - ROAD_FLAG_BITS;    // Distance in kilometers (1..ROAD_MAX_DISTANCE)
+    unsigned int flags : ROAD_FLAG_BITS;            // ROAD_* direction flags
+    struct Edge* next;                              // Pointer to next edge in list
 } Edge;
 
 /**
@@ -32,6 +76,67 @@ typedef struct City {
     Edge* adjList;                  // Head of adjacency list
 } City;
 
+/**
+ * Kinds of graph change events
+ */
+typedef enum GraphEventType {
+    EVENT_CITY_ADDED,
+    EVENT_CITY_REMOVED,
+    EVENT_CITY_UPDATED,
+    EVENT_ROAD_ADDED,
+    EVENT_ROAD_UPDATED,
+    EVENT_ROAD_REMOVED,
+    EVENT_PATH_HIGHLIGHTED
+} GraphEventType;
+
+/**
+ * Fine-grained change event
+ * Only the fields relevant to the event type are set
+ */
+typedef struct GraphEvent {
+    GraphEventType type;
+    int cityID;             // City, or road source
+    int toCityID;           // Road destination
+    dist_t distance;        // Road distance, or route total (EVENT_PATH_HIGHLIGHTED)
+    const int* path;        // Highlighted path city IDs (EVENT_PATH_HIGHLIGHTED)
+    int pathLength;
+} GraphEvent;
+
+/**
+ * Kinds of batched changes
+ */
+typedef enum GraphMutationType {
+    MUTATE_ADD_CITY,        // cityID, cityName, x, y
+    MUTATE_UPDATE_CITY,     // cityID keeps its roads; new cityName, x, y
+    MUTATE_REMOVE_CITY,     // cityID, with all its roads
+    MUTATE_SET_ROAD,        // cityID -> toCityID, added or updated to distance
+    MUTATE_REMOVE_ROAD      // cityID -> toCityID
+} GraphMutationType;
+
+/**
+ * One change in a batch
+ * Only the fields relevant to the type are read
+ */
+typedef struct GraphMutation {
+    GraphMutationType type;
+    int cityID;             // City, or road source
+    int toCityID;           // Road destination
+    int distance;           // Road distance
+    int x;
+    int y;
+    char cityName[MAX_CITY_NAME];
+} GraphMutation;
+
+struct Graph;
+
+/**
+ * Change listener callback
+ * @param g: Graph that changed (already updated)
+ * @param ev: Event description, valid only during the call
+ * @param userData: Listener context
+ */
+typedef void (*GraphEventListener)(struct Graph* g, const GraphEvent* ev, void* userData);
+
 /**
  * Graph structure
  * Dynamic array-based graph representation
@@ -40,8 +145,44 @@ typedef struct Graph {
     City* cities;           // Dynamic array of cities
     int numCities;          // Current number of cities
     int capacity;           // Allocated capacity
+    GraphEventListener listener;    // Change listener, or NULL
+    void* listenerData;             // Passed to listener
+    int* idSlots;           // Open-addressing city ID -> index table, -1 = empty
+    int idMask;             // idSlots size - 1 (power of two)
+    struct CSRGraph* csr;   // Cached CSR snapshot, NULL until prepared or after a change
+    unsigned long version;  // Incremented on every change
+    int quiet;              // Suppress per-city/road success messages and removeRoad's
+                            // not-found errors (bulk loading, reload diffs)
+    int symmetric;          // Merge A->B / B->A roads of equal distance into one two-way edge
+    struct EdgeSlab* edgeSlabs;     // Edge storage, EDGE_SLAB_EDGES at a time
+    int slabUsed;                   // Edges handed out from the newest slab
+    Edge* freeEdges;                // Removed edges, reused first (linked by next)
 } Graph;
 
+/**
+ * Compressed sparse row (CSR) snapshot of the graph
+ * Index-based, contiguous adjacency for bulk algorithms
+ * Edges of city index i are targets[offsets[i] .. offsets[i + 1] - 1]
+ * The transposed copy holds the same edges grouped by destination: roads into
+ * city index i are sources[inOffsets[i] .. inOffsets[i + 1] - 1]
+ * A cached snapshot may lack the transposed copy (inOffsets is NULL) when the
+ * memory budget refused it; buildCSR always fills both
+ */
+typedef struct CSRGraph {
+    int numCities;          // Number of cities at build time
+    int numEdges;           // Total number of directed edges
+    int* offsets;           // numCities + 1 edge offsets
+    int* targets;           // Destination city index per edge
+    int* weights;           // Distance per edge
+    int* inOffsets;         // numCities + 1 incoming edge offsets
+    int* sources;           // Source city index per incoming edge
+    int* inWeights;         // Distance per incoming edge
+    int* inEdgeIDs;         // Forward edge index of each incoming edge
+    int* reverseEdgeIDs;    // Incoming edge index of each forward edge
+    float* xs;              // X coordinate per city index (SoA, for heuristics)
+    float* ys;              // Y coordinate per city index (SoA, for heuristics)
+} CSRGraph;
+
 // GRAPH OPERATIONS 
 /**
  * Create a new graph with initial capacity
@@ -95,10 +236,12 @@ int findCityByName(Graph* g, const char* cityName);
 // ROAD OPERATIONS 
 /**
  * Add a directed road (edge) between two cities
+ * In symmetric mode, the mirror of an existing road with the same distance
+ * turns that road into a two-way edge instead of storing a second one
  * @param g: Pointer to graph
  * @param fromCityID: Source city ID
  * @param toCityID: Destination city ID
- * @param distance: Distance in kilometers
+ * @param distance: Distance in kilometers, 1..ROAD_MAX_DISTANCE
  * @return: 1 on success, 0 on failure
  */
 int addRoad(Graph* g, int fromCityID, int toCityID, int distance);
@@ -112,6 +255,108 @@ int addRoad(Graph* g, int fromCityID, int toCityID, int distance);
  */
 int removeRoad(Graph* g, int fromCityID, int toCityID);
 
+/**
+ * Look up the distance of a road, in either storage direction
+ * @param g: Pointer to graph
+ * @param fromCityID: Source city ID
+ * @param toCityID: Destination city ID
+ * @return: Distance in kilometers, or -1 if there is no such road
+ */
+int getRoadDistance(Graph* g, int fromCityID, int toCityID);
+
+// BATCH OPERATIONS
+/**
+ * Apply a batch of changes quietly, emitting the usual event per change
+ * Runs by kind - city removals, road removals, city additions and updates,
+ * then road additions and updates - so a road may name a city added in the
+ * same batch; entries of one kind run in array order. All removed cities
+ * go in one pass over the affected adjacency lists and one compaction.
+ * @param g: Pointer to graph
+ * @param ops: Changes to apply
+ * @param count: Number of changes
+ * @return: Number of changes applied
+ */
+int applyGraphMutations(Graph* g, const GraphMutation* ops, int count);
+
+// CHANGE EVENTS
+/**
+ * Register the change listener (replaces any previous one)
+ * @param g: Pointer to graph
+ * @param listener: Callback, or NULL to stop notifications
+ * @param userData: Passed to listener
+ */
+void setGraphEventListener(Graph* g, GraphEventListener listener, void* userData);
+
+/**
+ * Deliver an event to the graph's listener, if any
+ * Mutations emit their own events; callers use this for view events
+ * such as EVENT_PATH_HIGHLIGHTED
+ * @param g: Pointer to graph
+ * @param ev: Event to deliver
+ */
+void emitGraphEvent(Graph* g, const GraphEvent* ev);
+
+// CSR OPERATIONS
+/**
+ * Build a CSR snapshot of the current graph
+ * Resolves destination city IDs to array indices once
+ * @param g: Pointer to graph
+ * @return: Pointer to new CSR snapshot, or NULL on failure
+ */
+CSRGraph* buildCSR(Graph* g);
+
+/**
+ * Free a CSR snapshot
+ * @param csr: Pointer to CSR snapshot
+ */
+void freeCSR(CSRGraph* csr);
+
+/**
+ * Build and cache the graph's CSR snapshot
+ * The cache is dropped automatically by any change to the graph
+ * The transposed half is left out when it does not fit the memory budget
+ * @param g: Pointer to graph
+ * @return: 1 on success, 0 on failure
+ */
+int prepareGraph(Graph* g);
+
+/**
+ * Get a CSR snapshot for read-only use
+ * Returns the cached snapshot when one is valid, otherwise builds one with
+ * the forward rows only (inOffsets is NULL either way when missing)
+ * @param g: Pointer to graph
+ * @param temporary: Set to 1 when the snapshot was built for this caller
+ * @return: Pointer to CSR snapshot, or NULL on failure
+ */
+CSRGraph* acquireCSR(Graph* g, int* temporary);
+
+/**
+ * Get a CSR snapshot whose transposed half is filled
+ * Like acquireCSR, but a temporary snapshot gets both halves, and one is
+ * built when the cache lacks the transposed half
+ * @param g: Pointer to graph
+ * @param temporary: Set to 1 when the snapshot was built for this caller
+ * @return: Pointer to CSR snapshot, or NULL on failure
+ */
+CSRGraph* acquireTransposedCSR(Graph* g, int* temporary);
+
+/**
+ * Drop optional cached indices (the transposed CSR half) when the memory
+ * budget has no room for needed more bytes
+ * Caller must have exclusive access to the graph
+ * @param g: Pointer to graph
+ * @param needed: Bytes about to be allocated (0 to get back within budget)
+ * @return: Bytes released
+ */
+size_t trimGraphCaches(Graph* g, size_t needed);
+
+/**
+ * Release a snapshot from acquireCSR
+ * @param csr: Pointer to CSR snapshot
+ * @param temporary: Value set by acquireCSR
+ */
+void releaseCSR(CSRGraph* csr, int temporary);
+
 // ==================== DISPLAY FUNCTIONS ====================
 
 /**
@@ -0,0 +1,137 @@
+#ifndef MEMTRACK_H
+#define MEMTRACK_H
+
+#include <stddef.h>
+
+// CONSTANTS
+#define MEM_HUGE_PAGE_SIZE (2u << 20)       // Huge page size mappings are aligned to
+#define MEM_HUGE_BLOCK_BYTES (2u << 20)     // Blocks this large get their own mapping
+
+// MEMORY SUBSYSTEMS
+/**
+ * Owners of tracked allocations, one byte counter each
+ */
+typedef enum MemSubsystem {
+    MEM_GRAPH,      // Graph structs, city arrays, city ID indices
+    MEM_EDGES,      // Edge slabs
+    MEM_INDICES,    // CSR snapshots, forward and transposed
+    MEM_SEARCH,     // Search workspaces, heaps, results, BFS and stats scratch
+    MEM_RELOAD,     // Diff state of incremental reloads
+    MEM_SERVER,     // Request queues, per-request scratch, render feeds
+    NUM_MEM_SUBSYSTEMS
+} MemSubsystem;
+
+// Not tracked: the server, loader and thread handles (fixed size), the
+// map generator and the CLI's analysis and benchmark buffers, which run
+// outside the server and are freed before it could start
+
+/**
+ * Backing for large blocks (see MEM_HUGE_BLOCK_BYTES)
+ */
+typedef enum HugePageMode {
+    HUGE_PAGES_OFF,         // Always the C library allocator
+    HUGE_PAGES_TRANSPARENT, // mmap + madvise(MADV_HUGEPAGE), the default
+    HUGE_PAGES_EXPLICIT     // Reserved hugetlbfs pages first, then transparent
+} HugePageMode;
+
+/**
+ * Snapshot of the counters
+ * Bytes include the small per-block header, not the C library's overhead
+ */
+typedef struct MemStats {
+    size_t bytes[NUM_MEM_SUBSYSTEMS];   // Live bytes per subsystem
+    size_t total;                       // Live bytes, all subsystems
+    size_t peak;                        // Highest total so far
+    size_t budget;                      // 0 = unlimited
+    long refusals;                      // Optional work refused for the budget
+    size_t mapped;                      // Bytes mapped for large blocks
+    long hugeFallbacks;                 // Large blocks that fell back to malloc
+} MemStats;
+
+// TRACKED ALLOCATION
+/**
+ * malloc, charged to a subsystem
+ * Blocks of MEM_HUGE_BLOCK_BYTES or more get their own huge-page aligned
+ * mapping (see setHugePageMode)
+ * @param sys: Owning subsystem
+ * @param size: Bytes
+ * @return: Block, or NULL on failure
+ */
+void* memAlloc(MemSubsystem sys, size_t size);
+
+/**
+ * calloc, charged to a subsystem
+ * @param sys: Owning subsystem
+ * @param count: Elements
+ * @param size: Bytes per element
+ * @return: Zeroed block, or NULL on failure
+ */
+void* memCalloc(MemSubsystem sys, size_t count, size_t size);
+
+/**
+ * realloc of a tracked block (or NULL), charged to a subsystem
+ * @param sys: Owning subsystem
+ * @param ptr: Block from memAlloc/memCalloc/memRealloc, or NULL
+ * @param size: New size in bytes
+ * @return: Moved block, or NULL on failure (ptr is then still valid)
+ */
+void* memRealloc(MemSubsystem sys, void* ptr, size_t size);
+
+/**
+ * Free a tracked block and credit its subsystem
+ * @param ptr: Block from memAlloc/memCalloc/memRealloc, or NULL
+ */
+void memFree(void* ptr);
+
+/**
+ * Choose the backing of blocks of MEM_HUGE_BLOCK_BYTES or more
+ * Large CSR arrays and search workspaces are accessed at random, so
+ * huge pages cut their TLB misses. Every step falls back to the next
+ * (explicit, transparent, malloc) and the first failure of explicit
+ * pages turns it off; on systems without mmap this is a no-op
+ * @param mode: Backing to use for later blocks
+ */
+void setHugePageMode(HugePageMode mode);
+
+// MEMORY BUDGET
+/**
+ * Set the process-wide budget
+ * Optional work - cached indices, graph versions built ahead of a swap,
+ * large per-request scratch - is refused once it would not fit; the
+ * graph itself and the searches it must answer are never refused
+ * @param bytes: Budget in bytes, 0 for unlimited
+ */
+void setMemoryBudget(size_t bytes);
+
+/**
+ * Check whether more memory fits in the budget
+ * @param bytes: Bytes about to be allocated (0 checks current usage)
+ * @return: 1 if the total would stay within the budget
+ */
+int memoryFits(size_t bytes);
+
+/**
+ * Count and report optional work refused for the budget
+ * @param what: Short description ("CSR cache", ...)
+ */
+void noteMemoryRefusal(const char* what);
+
+/**
+ * Read all counters at once
+ * @param stats: Receives the snapshot
+ */
+void getMemStats(MemStats* stats);
+
+/**
+ * Printable subsystem name
+ * @param sys: Subsystem
+ * @return: Lower-case name ("graph", "edges", ...)
+ */
+const char* memSubsystemName(MemSubsystem sys);
+
+/**
+ * Print the counters as a table
+ */
+void displayMemStats(void);
+
+#endif // MEMTRACK_H
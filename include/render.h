@@ -0,0 +1,143 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include "graph.h"
+
+// RENDER CONSTANTS
+#define RENDER_CLUSTER_PX 24    // Default cluster cell size in pixels
+#define RENDER_MIN_EDGE_PX 4    // Default minimum drawn edge length in pixels
+#define POLYLINE_MAX_CHARS 7    // Encoded characters per value, worst case
+#define POLYLINE_MAX_DIMS 4     // Values per point
+
+// DATA STRUCTURES
+/**
+ * Visible area of the map and its size on screen
+ * World coordinates are the city x/y units
+ */
+typedef struct Viewport {
+    double minX, minY;      // World-space lower corner
+    double maxX, maxY;      // World-space upper corner
+    int widthPx;            // Screen width in pixels
+    int heightPx;           // Screen height in pixels
+} Viewport;
+
+/**
+ * Cluster of cities sharing one screen cell
+ */
+typedef struct RenderCluster {
+    float x, y;             // Centroid of member cities
+    int count;              // Number of member cities
+    int cityID;             // Representative (lowest) city ID
+} RenderCluster;
+
+/**
+ * Simplified road segment between two cluster centroids
+ */
+typedef struct RenderSegment {
+    float x1, y1;
+    float x2, y2;
+} RenderSegment;
+
+/**
+ * City on a highlighted path, drawn at full detail
+ */
+typedef struct RenderPoint {
+    int cityID;
+    float x, y;
+} RenderPoint;
+
+/**
+ * Level-of-detail render feed for one viewport and zoom level
+ */
+typedef struct RenderFeed {
+    RenderCluster* clusters;    // Visible clusters
+    int numClusters;
+    RenderSegment* edges;       // Deduplicated, culled cluster-to-cluster roads
+    int numEdges;
+    RenderPoint* path;          // Highlighted path cities in order
+    int pathLength;
+} RenderFeed;
+
+// RENDER OPERATIONS
+/**
+ * Build a render feed for a viewport
+ * Cities are clustered on a grid of clusterPx screen cells; roads become
+ * one segment per cluster pair and are dropped when shorter than minEdgePx
+ * on screen or entirely outside the viewport. The highlighted path is
+ * emitted city by city regardless of zoom.
+ * @param g: Pointer to graph
+ * @param vp: Viewport in world coordinates and pixels
+ * @param clusterPx: Cluster cell size in pixels (<= 0 for RENDER_CLUSTER_PX)
+ * @param minEdgePx: Minimum segment length in pixels (< 0 for RENDER_MIN_EDGE_PX)
+ * @param pathIDs: Highlighted path city IDs in order (may be NULL)
+ * @param pathLength: Number of path cities
+ * @return: Pointer to new feed, or NULL on failure
+ */
+RenderFeed* buildRenderFeed(Graph* g, const Viewport* vp, int clusterPx, int minEdgePx,
+                            const int* pathIDs, int pathLength);
+
+/**
+ * Free a render feed
+ * @param feed: Pointer to feed
+ */
+void freeRenderFeed(RenderFeed* feed);
+
+/**
+ * Write a feed as space-separated tokens on the current line
+ * Format: <clusters> <edges> <pathLength>, then x y count id per cluster,
+ * x1 y1 x2 y2 per edge, and id x y per path city
+ * With encodePath the path cities become one polyline token of x y
+ * (rounded), in place of the id x y triples
+ * @param feed: Pointer to feed
+ * @param out: Output stream
+ * @param encodePath: 1 to write the path as a polyline
+ */
+void writeRenderFeed(const RenderFeed* feed, FILE* out, int encodePath);
+
+// ROUTE GEOMETRY
+/**
+ * Encode integer points with the Google polyline algorithm
+ * Each value is stored as the delta from the previous point's value,
+ * zigzagged and written in 5-bit groups as printable ASCII '?'..'~',
+ * so the result never contains spaces and fits one protocol token.
+ * Values are kept as-is (precision 1), matching integer map units.
+ * @param values: count * dims integers, point by point
+ * @param count: Number of points
+ * @param dims: Values per point (1..POLYLINE_MAX_DIMS)
+ * @param out: Buffer of at least count * dims * POLYLINE_MAX_CHARS + 1 bytes
+ * @return: Encoded length, excluding the terminating '\0'
+ */
+size_t encodePolyline(const int* values, int count, int dims, char* out);
+
+/**
+ * Decode a polyline written by encodePolyline
+ * @param text: Encoded string
+ * @param dims: Values per point
+ * @param values: Output, room for maxPoints * dims integers
+ * @param maxPoints: Capacity in points
+ * @return: Number of points decoded, or -1 if malformed or too long
+ */
+int decodePolyline(const char* text, int dims, int* values, int maxPoints);
+
+/**
+ * Encode a route's city coordinates as an x/y polyline
+ * @param g: Pointer to graph
+ * @param pathIDs: Route city IDs in order
+ * @param pathLength: Number of cities
+ * @return: New string (caller frees with memFree), or NULL on unknown city or failure
+ */
+char* encodeRouteGeometry(Graph* g, const int* pathIDs, int pathLength);
+
+/**
+ * Encode cumulative distance at each route city as a 1-D polyline
+ * Starts at 0; since values are delta-coded, each step decodes from the
+ * hop length, which keeps long routes short. The shortest road between
+ * consecutive cities is used.
+ * @param g: Pointer to graph
+ * @param pathIDs: Route city IDs in order
+ * @param pathLength: Number of cities
+ * @return: New string (caller frees with memFree), or NULL if a hop has no road or on failure
+ */
+char* encodeRouteDistances(Graph* g, const int* pathIDs, int pathLength);
+
+#endif // RENDER_H
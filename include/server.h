@@ -0,0 +1,167 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "graph.h"
+#include "algorithms.h"
+#include "fileio.h"
+
+// SERVER CONSTANTS
+#define SERVER_MAX_LINE 4096
+#define SERVER_MAX_TAG 32
+#define SERVER_LATENCY_SAMPLES 1024
+#define SERVER_WATCH_SETTLE_MS 300      // Quiet time after a map file write before rebuilding
+#define SERVER_WATCH_POLL_MS 250        // Shutdown check (and, without inotify, stat) interval of the file watcher
+#define SERVER_MUTATION_QUEUE 64        // Mutations waiting for the writer thread
+
+// REQUEST CLASSES
+/**
+ * Request classes with separate queues and metrics
+ * Interactive requests always run before batch requests
+ */
+typedef enum RequestClass {
+    CLASS_INTERACTIVE = 0,  // GUI route queries, latency sensitive
+    CLASS_BATCH,            // Matrix and analytics jobs, throttled
+    NUM_REQUEST_CLASSES
+} RequestClass;
+
+/**
+ * Queued server request
+ * One protocol line plus its arrival time
+ */
+typedef struct ServerRequest {
+    char tag[SERVER_MAX_TAG];       // Client-chosen tag echoed in the response
+    char line[SERVER_MAX_LINE];     // Command and arguments (tag stripped)
+    RequestClass cls;               // Request class
+    double enqueuedMs;              // Arrival time (currentTimeMs clock)
+} ServerRequest;
+
+/**
+ * Bounded FIFO ring buffer of requests
+ */
+typedef struct RequestQueue {
+    ServerRequest* items;   // Ring buffer storage
+    int head;               // Index of oldest request
+    int count;              // Number of queued requests
+    int capacity;           // Maximum queued requests
+} RequestQueue;
+
+/**
+ * Per-class admission and latency metrics
+ */
+typedef struct ClassMetrics {
+    long accepted;          // Requests admitted to the queue
+    long rejected;          // Requests shed with BUSY
+    long completed;         // Requests answered by a worker
+    long timedOut;          // Requests stopped by their deadline
+    double totalLatencyMs;  // Sum of queue + service latency
+    double maxLatencyMs;    // Worst latency seen
+    double samples[SERVER_LATENCY_SAMPLES];  // Recent latencies for percentiles
+    int numSamples;         // Valid entries in samples (ring)
+    int nextSample;         // Next slot to overwrite
+} ClassMetrics;
+
+/**
+ * Server tuning knobs
+ */
+typedef struct ServerConfig {
+    int numWorkers;                             // Worker threads
+    int maxConcurrentBatch;                     // Workers batch jobs may occupy at once
+    int queueCapacity[NUM_REQUEST_CLASSES];     // Bounded queue size per class
+    double budgetMs[NUM_REQUEST_CLASSES];       // Queue wait + search budget per class
+    const char* citiesFile;                     // Load in the background when set
+    const char* roadsFile;
+    int watchFiles;                             // Swap in a rebuilt graph when the files change
+} ServerConfig;
+
+// SERVER OPERATIONS
+/**
+ * Fill a config with defaults
+ * 4 workers, at most 1 running batch job, 64/16 queue slots,
+ * 250 ms interactive and 30 s batch budgets, graph already loaded,
+ * map files watched once set
+ * @param config: Pointer to config
+ */
+void initServerConfig(ServerConfig* config);
+
+/**
+ * Run the line-protocol server until QUIT or end of input
+ *
+ * Each input line is "<tag> <COMMAND> [args]"; each response is one line
+ * starting with the same tag. Commands:
+ *   ROUTE DIJKSTRA|ASTAR <fromID> <toID> [POLYLINE] [DISTANCES]
+ *         [VIA <id> ...] [AVOID <id> ...] [AVOIDROAD <from> <to> ...]
+ *                                           (interactive; POLYLINE/DISTANCES
+ *                                           append the encoded x/y geometry and
+ *                                           cumulative distances after the IDs,
+ *                                           VIA adds ordered stops and appends
+ *                                           "SEGMENTS <n> <end index> ...",
+ *                                           AVOID/AVOIDROAD route around cities
+ *                                           and one-way roads)
+ *   RENDER <minX> <minY> <maxX> <maxY> <widthPx> <heightPx> [POLYLINE] [pathID ...]
+ *                                           (interactive, level-of-detail feed)
+ *   MATRIX <id> <id> ...                    (batch, distance matrix)
+ *   HOPS <id> <id> ...                      (batch, hop-distance rows;
+ *                                           "ERROR unknown city" if any ID is
+ *                                           not on the map, as for ROUTE)
+ *   GRAPHSTATS                              (batch, graphStats summary as
+ *                                           key=value pairs; histograms are
+ *                                           comma-separated bucket counts,
+ *                                           weights bucket 0 holds length 0
+ *                                           and bucket b > 0 [2^(b-1), 2^b))
+ *   STATS                                   (answered immediately)
+ *   MEMSTATS                                (answered immediately; tracked
+ *                                           bytes as "total= peak= budget=
+ *                                           refused= mapped=" then one key
+ *                                           per subsystem)
+ *   ADDCITY <id> <x> <y> <name>, DELCITY <id>,
+ *   ADDROAD <from> <to> <distance>, DELROAD <from> <to>,
+ *   HIGHLIGHT <id> <id> ...                 (applied in order by the writer)
+ *   RELOAD                                  (applied in order by the writer; diffs
+ *                                           changed map files against the graph,
+ *                                           answers
+ *                                           "OK files=<n> blocks=<n> cities=+a,-r,~c
+ *                                           roads=+a,-r,~c rejected=<n> ms=<t>")
+ *   QUIT
+ * Responses: OK ..., NOPATH, TIMEOUT, BUSY <class>, ERROR <reason>
+ * Graph changes and highlighted routes are also broadcast as untagged
+ * "* EVENT <type> ..." lines so views can update incrementally
+ *
+ * Mutations are queued for a single writer thread, which applies them in
+ * arrival order once running queries release the graph; the reader keeps
+ * admitting or shedding other requests meanwhile. A full mutation queue
+ * answers "BUSY mutation". Queries sent after a mutation may still run on
+ * the graph before it, so clients wait for its OK (or its EVENT) first
+ *
+ * With config->citiesFile/roadsFile set, the graph loads in the background:
+ * requests get "BUSY loading" until cities and roads are in, ASTAR routes
+ * run as Dijkstra until the CSR cache is built, and each stage is
+ * broadcast as "* EVENT LOAD <stage> <cities> <roads>"
+ *
+ * With config->watchFiles also set (inotify on Linux, size/mtime polling
+ * elsewhere), writes to the map files rebuild the graph on a background
+ * thread once they settle; the new version replaces the old between
+ * requests (in-flight queries finish on the old one) and is broadcast as
+ * "* EVENT VERSION <n> <cities> <roads>" with no per-change events, so
+ * clients reread the map. A later RELOAD diffs against the swapped-in files.
+ * A rebuild needs memory for both versions; a file that fails to load,
+ * or a rebuild that does not fit the memory budget, keeps the current
+ * version. MATRIX and HOPS answer "ERROR memory budget" when their result
+ * would not fit
+ *
+ * @param g: Pointer to graph (empty when loading in the background)
+ * @param config: Server configuration
+ * @param in: Request stream
+ * @param out: Response stream
+ * @return: 1 on clean shutdown, 0 on failure
+ */
+int runServer(Graph* g, const ServerConfig* config, FILE* in, FILE* out);
+
+/**
+ * Reserve stdout for protocol responses
+ * Duplicates stdout for the returned stream and points stdout at stderr,
+ * so diagnostic printf output from the backend cannot corrupt responses
+ * @return: Response stream, or NULL on failure
+ */
+FILE* openProtocolOutput(void);
+
+#endif // SERVER_H
@@ -1,22 +1,126 @@
+#define _POSIX_C_SOURCE 200809L    // clock_gettime and sysconf under -std=c11
 #include "algorithms.h"
+#include "memtrack.h"
 #include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <time.h>
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// Read hint for an address needed a few iterations later
+#if SEARCH_PREFETCH_DISTANCE > 0 && defined(__GNUC__)
+#define PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define PREFETCH(addr) ((void)(addr))
+#endif
+
+// SEARCH CONTROL
+/* Monotonic wall clock in milliseconds */
+double currentTimeMs(void)
+{
+#if defined(_WIN32)
+    return (double)clock() * 1000.0 / CLOCKS_PER_SEC;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+#endif
+}
+
+/* Initialize control with a budget from now */
+void initSearchControl(SearchControl *ctl, double budgetMs)
+{
+    ctl->deadlineMs = budgetMs > 0 ? currentTimeMs() + budgetMs : 0;
+    ctl->cancelled = 0;
+    ctl->checkInterval = SEARCH_CHECK_INTERVAL;
+    ctl->work = 0;
+    ctl->status = SEARCH_OK;
+}
+
+/* Request cancellation */
+void cancelSearch(SearchControl *ctl)
+{
+    if (ctl)
+        ctl->cancelled = 1;
+}
+
+/* Check cancel flag always, the clock every checkInterval relaxations */
+int searchShouldStop(SearchControl *ctl, int work)
+{
+    if (!ctl)
+        return 0;
+
+    if (ctl->cancelled)
+    {
+        ctl->status = SEARCH_CANCELLED;
+        return 1;
+    }
+
+    ctl->work += work;
+    if (ctl->work < ctl->checkInterval)
+        return 0;
+    ctl->work = 0;
+
+    if (ctl->deadlineMs > 0 && currentTimeMs() >= ctl->deadlineMs)
+    {
+        ctl->status = SEARCH_DEADLINE;
+        return 1;
+    }
+    return 0;
+}
+
+/* Reset per-search state of a control */
+static void beginSearch(SearchControl *ctl)
+{
+    if (ctl)
+    {
+        ctl->work = 0;
+        ctl->status = SEARCH_OK;
+    }
+}
+
+/* True if the control stopped the search early */
+static int searchStopped(SearchControl *ctl)
+{
+    return ctl && (ctl->status == SEARCH_DEADLINE || ctl->status == SEARCH_CANCELLED);
+}
+
+/* Report why a search ended without a result */
+static void reportNoPath(SearchControl *ctl)
+{
+    if (searchStopped(ctl))
+    {
+        printf("Search stopped early (%s)!\n",
+               ctl->status == SEARCH_DEADLINE ? "deadline passed" : "cancelled");
+        return;
+    }
+    if (ctl)
+        ctl->status = SEARCH_NO_PATH;
+    printf("No path exists between these cities!\n");
+}
 
 // MIN-HEAP IMPLEMENTATION
 /* Create min-heap with given capacity*/
 MinHeap *createMinHeap(int capacity)
 {
-    MinHeap *h = (MinHeap *)malloc(sizeof(MinHeap));
+    MinHeap *h = (MinHeap *)memAlloc(MEM_SEARCH, sizeof(MinHeap));
     if (!h)
         return NULL;
 
-    h->nodes = (HeapNode *)malloc(capacity * sizeof(HeapNode));
-    h->pos = (int *)malloc(1000 * sizeof(int)); // Support up to 1000 cities
+    int size = capacity > 0 ? capacity : 1;
+    h->nodes = (HeapNode *)memAlloc(MEM_SEARCH, size * sizeof(HeapNode));
+    h->pos = (int *)memAlloc(MEM_SEARCH, size * sizeof(int)); // Keys are city indices < capacity
 
     if (!h->nodes || !h->pos)
     {
-        free(h->nodes);
-        free(h->pos);
-        free(h);
+        memFree(h->nodes);
+        memFree(h->pos);
+        memFree(h);
         return NULL;
     }
 
@@ -24,7 +128,7 @@ MinHeap *createMinHeap(int capacity)
     h->capacity = capacity;
 
     // Initialize position array
-    for (int i = 0; i < 1000; i++)
+    for (int i = 0; i < size; i++)
     {
         h->pos[i] = -1;
     }
@@ -36,9 +140,9 @@ void freeMinHeap(MinHeap *h)
 {
     if (h)
     {
-        free(h->nodes);
-        free(h->pos);
-        free(h);
+        memFree(h->nodes);
+        memFree(h->pos);
+        memFree(h);
     }
 }
 
@@ -92,10 +196,10 @@ HeapNode extractMin(MinHeap *h)
     HeapNode root = h->nodes[0];
     HeapNode lastNode = h->nodes[h->size - 1];
 
-    // Move last node to root
+    // Move last node to root (root last: it may be the same node)
     h->nodes[0] = lastNode;
-    h->pos[root.cityID] = -1;
     h->pos[lastNode.cityID] = 0;
+    h->pos[root.cityID] = -1;
 
     h->size--;
     minHeapify(h, 0);
@@ -104,7 +208,7 @@ HeapNode extractMin(MinHeap *h)
 }
 
 /* Decrease key value for a city */
-void decreaseKey(MinHeap *h, int cityID, int newDist, int newFScore)
+void decreaseKey(MinHeap *h, int cityID, dist_t newDist, dist_t newFScore)
 {
     int i = h->pos[cityID];
     if (i == -1)
@@ -125,7 +229,7 @@ void decreaseKey(MinHeap *h, int cityID, int newDist, int newFScore)
 }
 
 /* Insert node into heap */
-void insertHeap(MinHeap *h, int cityID, int distance, int fScore)
+void insertHeap(MinHeap *h, int cityID, dist_t distance, dist_t fScore)
 {
     if (h->size >= h->capacity)
         return;
@@ -153,20 +257,23 @@ void insertHeap(MinHeap *h, int cityID, int distance, int fScore)
 /* Create PathResult structure */
 PathResult *createPathResult(int capacity)
 {
-    PathResult *pr = (PathResult *)malloc(sizeof(PathResult));
+    PathResult *pr = (PathResult *)memCalloc(MEM_SEARCH, 1, sizeof(PathResult));
     if (!pr)
         return NULL;
 
-    pr->path = (int *)malloc(capacity * sizeof(int));
-    if (!pr->path)
+    if (capacity > 0)
     {
-        free(pr);
-        return NULL;
+        pr->path = (int *)memAlloc(MEM_SEARCH, capacity * sizeof(int));
+        if (!pr->path)
+        {
+            memFree(pr);
+            return NULL;
+        }
     }
 
     pr->pathLength = 0;
     pr->totalDistance = 0;
-    pr->pathCapacity = capacity;
+    pr->pathCapacity = capacity > 0 ? capacity : 0;
     return pr;
 }
 
@@ -175,19 +282,99 @@ void freePathResult(PathResult *pr)
 {
     if (pr)
     {
-        free(pr->path);
-        free(pr);
+        memFree(pr->path);
+        memFree(pr->indices);
+        memFree(pr->segmentEnds);
+        memFree(pr->segmentDistances);
+        memFree(pr);
     }
 }
 
+/* Packed result - copies the parent chain from destIndex back to the
+ * source as city indices, so the search's O(n) parent array is not kept */
+static PathResult *packPath(Graph *g, const int *parent, int destIndex, dist_t distance)
+{
+    PathResult *pr = createPathResult(0);
+    if (!pr)
+        return NULL;
+
+    int length = 0;
+    for (int current = destIndex; current != -1; current = parent[current])
+        length++;
+    pr->indices = (int *)memAlloc(MEM_SEARCH, length * sizeof(int));
+    if (!pr->indices)
+    {
+        freePathResult(pr);
+        return NULL;
+    }
+
+    int i = length;
+    for (int current = destIndex; current != -1; current = parent[current])
+        pr->indices[--i] = current;
+    pr->pathLength = length;
+    pr->totalDistance = distance;
+    pr->graph = g;
+    pr->graphVersion = g->version;
+    return pr;
+}
+
+/* Copy path IDs into buffer, mapping packed city indices to IDs */
+int unpackPath(const PathResult *pr, int *buffer, int capacity)
+{
+    if (!pr || capacity < pr->pathLength)
+        return -1;
+
+    if (!pr->indices)
+    {
+        if (pr->pathLength > 0)
+            memcpy(buffer, pr->path, pr->pathLength * sizeof(int));
+        return pr->pathLength;
+    }
+
+    if (pr->graph->version != pr->graphVersion)
+    {
+        printf("Error: Graph changed since the search, path unavailable!\n");
+        return -1;
+    }
+
+    for (int i = 0; i < pr->pathLength; i++)
+        buffer[i] = pr->graph->cities[pr->indices[i]].cityID;
+    return pr->pathLength;
+}
+
+/* Materialise path on first request */
+const int *getPath(PathResult *pr)
+{
+    if (!pr || pr->pathLength == 0)
+        return NULL;
+    if (!pr->indices)
+        return pr->path;
+
+    int *path = (int *)memAlloc(MEM_SEARCH, pr->pathLength * sizeof(int));
+    if (!path)
+        return NULL;
+    if (unpackPath(pr, path, pr->pathLength) < 0)
+    {
+        memFree(path);
+        return NULL;
+    }
+
+    memFree(pr->path);
+    memFree(pr->indices);
+    pr->path = path;
+    pr->pathCapacity = pr->pathLength;
+    pr->indices = NULL;
+    return pr->path;
+}
+
 /* Add city to path */
 void addToPath(PathResult *pr, int cityID)
 {
     if (pr->pathLength >= pr->pathCapacity)
     {
         // Resize if needed
-        pr->pathCapacity *= 2;
-        pr->path = (int *)realloc(pr->path, pr->pathCapacity * sizeof(int));
+        pr->pathCapacity = pr->pathCapacity > 0 ? pr->pathCapacity * 2 : 8;
+        pr->path = (int *)memRealloc(MEM_SEARCH, pr->path, pr->pathCapacity * sizeof(int));
         if (!pr->path)
             return;
     }
@@ -207,7 +394,7 @@ void reversePath(PathResult *pr)
 
 // BFS TRAVERSAL
 /* Breadth-First Search traversal */
-void BFS(Graph *g, int startCityID)
+void BFS(Graph *g, int startCityID, SearchControl *ctl)
 {
     if (!g)
     {
@@ -222,19 +409,23 @@ void BFS(Graph *g, int startCityID)
         return;
     }
 
-    int *visited = (int *)calloc(g->numCities, sizeof(int));
-    int *queue = (int *)malloc(g->numCities * sizeof(int));
+    int tempCSR;
+    CSRGraph *csr = acquireCSR(g, &tempCSR);
+    int *visited = (int *)memCalloc(MEM_SEARCH, g->numCities, sizeof(int));
+    int *queue = (int *)memAlloc(MEM_SEARCH, g->numCities * sizeof(int));
 
-    if (!visited || !queue)
+    if (!csr || !visited || !queue)
     {
-        free(visited);
-        free(queue);
+        releaseCSR(csr, tempCSR);
+        memFree(visited);
+        memFree(queue);
         printf("Error: Memory allocation failed!\n");
         return;
     }
 
     int front = 0, rear = 0;
 
+    beginSearch(ctl);
     visited[startIndex] = 1;
     queue[rear++] = startIndex;
 
@@ -249,67 +440,78 @@ void BFS(Graph *g, int startCityID)
         int current = queue[front++];
         printf("%s", g->cities[current].cityName);
 
-        Edge *edge = g->cities[current].adjList;
-        while (edge)
+        for (int e = csr->offsets[current]; e < csr->offsets[current + 1]; e++)
         {
-            int destIndex = findCityIndex(g, edge->destCityID);
-            if (destIndex != -1 && !visited[destIndex])
+            int destIndex = csr->targets[e];
+            if (!visited[destIndex])
             {
                 visited[destIndex] = 1;
                 queue[rear++] = destIndex;
             }
-            edge = edge->next;
         }
 
         if (front < rear)
+        {
+            if (searchShouldStop(ctl, 1))
+            {
+                printf(" … (stopped early)");
+                break;
+            }
             printf(" → ");
+        }
     }
     printf("\n════════════════════════════════════════════════════\n");
 
-    free(visited);
-    free(queue);
+    releaseCSR(csr, tempCSR);
+    memFree(visited);
+    memFree(queue);
 }
 
 // DFS TRAVERSAL
 /* DFS utility function (recursive) */
-void DFSUtil(Graph *g, int cityIndex, int *visited)
+void DFSUtil(Graph *g, const CSRGraph *csr, int cityIndex, int *visited, SearchControl *ctl)
 {
     visited[cityIndex] = 1;
     printf("%s", g->cities[cityIndex].cityName);
 
-    Edge *edge = g->cities[cityIndex].adjList;
     int hasUnvisited = 0;
 
     // Check if there are unvisited neighbors
-    Edge *temp = edge;
-    while (temp)
+    for (int e = csr->offsets[cityIndex]; e < csr->offsets[cityIndex + 1]; e++)
     {
-        int destIndex = findCityIndex(g, temp->destCityID);
-        if (destIndex != -1 && !visited[destIndex])
+        if (!visited[csr->targets[e]])
         {
             hasUnvisited = 1;
             break;
         }
-        temp = temp->next;
     }
 
     if (hasUnvisited)
+    {
+        if (searchShouldStop(ctl, 1))
+        {
+            printf(" … (stopped early)");
+            return;
+        }
         printf(" → ");
+    }
 
     // Visit unvisited neighbors
-    while (edge)
+    for (int e = csr->offsets[cityIndex]; e < csr->offsets[cityIndex + 1]; e++)
     {
-        int destIndex = findCityIndex(g, edge->destCityID);
-        if (destIndex != -1 && !visited[destIndex])
+        if (searchStopped(ctl))
+            return;
+
+        int destIndex = csr->targets[e];
+        if (!visited[destIndex])
         {
-            DFSUtil(g, destIndex, visited);
+            DFSUtil(g, csr, destIndex, visited, ctl);
         }
-        edge = edge->next;
     }
 }
 
 /* Depth-First Search traversal */
-void DFS(Graph *g, int startCityID)
+void DFS(Graph *g, int startCityID, SearchControl *ctl)
 {
     if (!g)
     {
@@ -324,9 +526,13 @@ void DFS(Graph *g, int startCityID)
         return;
     }
 
-    int *visited = (int *)calloc(g->numCities, sizeof(int));
-    if (!visited)
+    int tempCSR;
+    CSRGraph *csr = acquireCSR(g, &tempCSR);
+    int *visited = (int *)memCalloc(MEM_SEARCH, g->numCities, sizeof(int));
+    if (!csr || !visited)
     {
+        releaseCSR(csr, tempCSR);
+        memFree(visited);
         printf("Error: Memory allocation failed!\n");
         return;
     }
@@ -337,23 +543,502 @@ void DFS(Graph *g, int startCityID)
     printf("Starting from: %s\n\n", g->cities[startIndex].cityName);
     printf("Order: ");
 
-    DFSUtil(g, startIndex, visited);
+    beginSearch(ctl);
+    DFSUtil(g, csr, startIndex, visited, ctl);
 
     printf("\n════════════════════════════════════════════════════\n");
 
-    free(visited);
+    releaseCSR(csr, tempCSR);
+    memFree(visited);
 }
 
-// DIJKSTRA'S ALGORITHM
-/*Dijkstra's shortest path algorithm */
-PathResult *dijkstra(Graph *g, int sourceCityID, int destCityID)
+// MULTI-SOURCE BFS
+/* Index of lowest set bit in a non-zero word */
+static int lowestBit(uint64_t w)
 {
-    if (!g)
+#if defined(__GNUC__)
+    return __builtin_ctzll(w);
+#else
+    int b = 0;
+    while (!(w & 1))
+    {
+        w >>= 1;
+        b++;
+    }
+    return b;
+#endif
+}
+
+/* dst |= src over one city's source mask */
+static void maskOr(uint64_t *dst, const uint64_t *src)
+{
+#if defined(__AVX2__) && MSBFS_WORDS == 4
+    __m256i a = _mm256_loadu_si256((const __m256i *)dst);
+    __m256i b = _mm256_loadu_si256((const __m256i *)src);
+    _mm256_storeu_si256((__m256i *)dst, _mm256_or_si256(a, b));
+#else
+    for (int w = 0; w < MSBFS_WORDS; w++)
+        dst[w] |= src[w];
+#endif
+}
+
+/* Bit-parallel multi-source BFS */
+int multiSourceBFS(Graph *g, const int *sourceIDs, int numSources, int *hopDist,
+                   SearchControl *ctl)
+{
+    if (!g || !sourceIDs || !hopDist || numSources <= 0)
+    {
+        printf("Error: Invalid parameters!\n");
+        return 0;
+    }
+
+    int n = g->numCities;
+    for (long i = 0; i < (long)numSources * n; i++)
+        hopDist[i] = -1;
+
+    int tempCSR;
+    CSRGraph *csr = acquireCSR(g, &tempCSR);
+    uint64_t *seen = (uint64_t *)memAlloc(MEM_SEARCH, (size_t)n * MSBFS_WORDS * sizeof(uint64_t));
+    uint64_t *visit = (uint64_t *)memAlloc(MEM_SEARCH, (size_t)n * MSBFS_WORDS * sizeof(uint64_t));
+    uint64_t *next = (uint64_t *)memAlloc(MEM_SEARCH, (size_t)n * MSBFS_WORDS * sizeof(uint64_t));
+
+    if (!csr || !seen || !visit || !next)
+    {
+        releaseCSR(csr, tempCSR);
+        memFree(seen);
+        memFree(visit);
+        memFree(next);
+        printf("Error: Memory allocation failed!\n");
+        return 0;
+    }
+
+    beginSearch(ctl);
+    int stopped = 0;
+    for (int base = 0; base < numSources && !stopped; base += MSBFS_BATCH)
+    {
+        int batch = numSources - base < MSBFS_BATCH ? numSources - base : MSBFS_BATCH;
+
+        memset(seen, 0, (size_t)n * MSBFS_WORDS * sizeof(uint64_t));
+        memset(visit, 0, (size_t)n * MSBFS_WORDS * sizeof(uint64_t));
+        memset(next, 0, (size_t)n * MSBFS_WORDS * sizeof(uint64_t));
+
+        // Seed one bit per source
+        int active = 0;
+        for (int b = 0; b < batch; b++)
+        {
+            int s = findCityIndex(g, sourceIDs[base + b]);
+            if (s == -1)
+                continue;
+            seen[s * MSBFS_WORDS + b / 64] |= (uint64_t)1 << (b % 64);
+            visit[s * MSBFS_WORDS + b / 64] |= (uint64_t)1 << (b % 64);
+            hopDist[(long)(base + b) * n + s] = 0;
+            active = 1;
+        }
+
+        int level = 0;
+        while (active)
+        {
+            level++;
+            active = 0;
+
+            // Push every frontier mask along outgoing edges
+            for (int u = 0; u < n; u++)
+            {
+                uint64_t *fu = &visit[u * MSBFS_WORDS];
+                uint64_t any = 0;
+                for (int w = 0; w < MSBFS_WORDS; w++)
+                    any |= fu[w];
+                if (!any)
+                    continue;
+
+                int end = csr->offsets[u + 1];
+                for (int e = csr->offsets[u]; e < end; e++)
+                {
+                    if (SEARCH_PREFETCH_DISTANCE > 0 && e + SEARCH_PREFETCH_DISTANCE < end)
+                        PREFETCH(&next[csr->targets[e + SEARCH_PREFETCH_DISTANCE] * MSBFS_WORDS]);
+                    maskOr(&next[csr->targets[e] * MSBFS_WORDS], fu);
+                }
+
+                if (searchShouldStop(ctl, csr->offsets[u + 1] - csr->offsets[u] + 1))
+                {
+                    stopped = 1;
+                    break;
+                }
+            }
+            if (stopped)
+                break;
+
+            // Keep only first-time discoveries and record their level
+            for (int v = 0; v < n; v++)
+            {
+                for (int w = 0; w < MSBFS_WORDS; w++)
+                {
+                    uint64_t fresh = next[v * MSBFS_WORDS + w] & ~seen[v * MSBFS_WORDS + w];
+                    seen[v * MSBFS_WORDS + w] |= fresh;
+                    visit[v * MSBFS_WORDS + w] = fresh;
+                    next[v * MSBFS_WORDS + w] = 0;
+
+                    if (fresh)
+                        active = 1;
+                    while (fresh)
+                    {
+                        int b = w * 64 + lowestBit(fresh);
+                        hopDist[(long)(base + b) * n + v] = level;
+                        fresh &= fresh - 1;
+                    }
+                }
+            }
+        }
+    }
+
+    releaseCSR(csr, tempCSR);
+    memFree(seen);
+    memFree(visit);
+    memFree(next);
+    return !stopped;
+}
+
+// A* HEURISTIC
+/* Heuristic function - Euclidean distance */
+int heuristic(Graph *g, int cityIndex1, int cityIndex2)
+{
+    int dx = g->cities[cityIndex1].x - g->cities[cityIndex2].x;
+    int dy = g->cities[cityIndex1].y - g->cities[cityIndex2].y;
+    return (int)sqrt(dx * dx + dy * dy);
+}
+
+/* Batch heuristic for a set of city indices against target (tx, ty)
+ * Same truncated Euclidean distance as heuristic(), computed on the
+ * float SoA coordinates 8 lanes at a time when AVX2 is available */
+static void batchHeuristic(const float *xs, const float *ys, const int *idx,
+                           int count, float tx, float ty, int *out)
+{
+    int i = 0;
+#if defined(__AVX2__)
+    __m256 vtx = _mm256_set1_ps(tx);
+    __m256 vty = _mm256_set1_ps(ty);
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i vi = _mm256_loadu_si256((const __m256i *)&idx[i]);
+        __m256 dx = _mm256_sub_ps(_mm256_i32gather_ps(xs, vi, 4), vtx);
+        __m256 dy = _mm256_sub_ps(_mm256_i32gather_ps(ys, vi, 4), vty);
+        __m256 d2 = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+        _mm256_storeu_si256((__m256i *)&out[i], _mm256_cvttps_epi32(_mm256_sqrt_ps(d2)));
+    }
+#endif
+    for (; i < count; i++)
+    {
+        float dx = xs[idx[i]] - tx;
+        float dy = ys[idx[i]] - ty;
+        out[i] = (int)sqrtf(dx * dx + dy * dy);
+    }
+}
+
+/* Evaluate heuristics of all first-seen neighbours of u in one batch */
+static void evaluateNeighbourHeuristics(CSRGraph *csr, int u, int *hCache,
+                                        int *pending, int *hBatch, float tx, float ty)
+{
+    int numPending = 0;
+    for (int e = csr->offsets[u]; e < csr->offsets[u + 1]; e++)
+    {
+        int v = csr->targets[e];
+        if (hCache[v] == -1)
+        {
+            hCache[v] = 0; // Queued, avoids duplicates from parallel roads
+            pending[numPending++] = v;
+        }
+    }
+    batchHeuristic(csr->xs, csr->ys, pending, numPending, tx, ty, hBatch);
+    for (int i = 0; i < numPending; i++)
+        hCache[pending[i]] = hBatch[i];
+}
+
+/* Inflated heuristic term of the f-score */
+static dist_t inflate(int h, double epsilon)
+{
+    return epsilon == 1.0 ? h : (dist_t)(epsilon * h);
+}
+
+// SEARCH KERNELS
+/**
+ * Search workspace, reusable across searches on the same graph
+ * Arrays are indexed by city index; hCache and friends only with a heuristic
+ */
+typedef struct SearchState {
+    CSRGraph *csr;
+    int tempCSR;        // csr is a private copy to release
+    int n;
+    const int *offsets; // Forward or transposed adjacency of the current search
+    const int *targets;
+    const int *weights;
+    const int *edgeIDs; // Forward edge index per slot, NULL when searching forward
+    MinHeap *h;
+    dist_t *gScore;
+    int *parent;
+    int ownScores;      // gScore/parent allocated here (not borrowed)
+    int *hCache;        // Heuristic per city, -1 = not evaluated
+    int *pending;       // Neighbours awaiting batch evaluation
+    int *hBatch;
+    int srcIndex;
+    int destIndex;      // -1 for a full tree
+    int variant;        // Kernel of the current search
+    float tx, ty;       // Target coordinates for the heuristic
+    double epsilon;
+    EdgeFilter filter;
+    void *filterData;
+    SearchStats *stats;
+    SearchControl *ctl;
+} SearchState;
+
+/*
+ * One search loop, specialised per variant at compile time. The flags are
+ * constants, so the compiler drops the unused branches from each copy.
+ *   HEURISTIC:  f = g + epsilon * h (A*), otherwise f = g (Dijkstra)
+ *   EARLY_EXIT: stop when the destination is settled, otherwise settle all
+ *   FILTER:     skip roads the filter rejects
+ *   STATS:      count settled cities and relaxed roads
+ * Unless SEARCH_PREFETCH_DISTANCE is 0, each road prefetches the score and
+ * heap slot of the neighbour that many roads ahead, and each settle the
+ * row of the next heap minimum.
+ */
+#define DEFINE_SEARCH_KERNEL(NAME, HEURISTIC, EARLY_EXIT, FILTER, STATS)                  \
+    static void NAME(SearchState *st)                                                     \
+    {                                                                                     \
+        const int *offsets = st->offsets;                                                 \
+        const int *targets = st->targets;                                                 \
+        const int *weights = st->weights;                                                 \
+        MinHeap *h = st->h;                                                               \
+        dist_t *gScore = st->gScore;                                                      \
+        int *parent = st->parent;                                                         \
+                                                                                          \
+        while (!isHeapEmpty(h))                                                           \
+        {                                                                                 \
+            int u = extractMin(h).cityID;                                                 \
+            if (SEARCH_PREFETCH_DISTANCE > 0 && h->size > 0)                              \
+                PREFETCH(&offsets[h->nodes[0].cityID]); /* Likely next u */               \
+            if (STATS)                                                                    \
+                st->stats->settled++;                                                     \
+            if (EARLY_EXIT && u == st->destIndex)                                         \
+                break;                                                                    \
+            if (searchShouldStop(st->ctl, offsets[u + 1] - offsets[u] + 1))               \
+                break;                                                                    \
+            if (HEURISTIC)                                                                \
+                evaluateNeighbourHeuristics(st->csr, u, st->hCache, st->pending,          \
+                                            st->hBatch, st->tx, st->ty);                  \
+                                                                                          \
+            int end = offsets[u + 1];                                                     \
+            for (int e = offsets[u]; e < end; e++)                                        \
+            {                                                                             \
+                if (SEARCH_PREFETCH_DISTANCE > 0 && e + SEARCH_PREFETCH_DISTANCE < end)   \
+                {                                                                         \
+                    int ahead = targets[e + SEARCH_PREFETCH_DISTANCE];                    \
+                    PREFETCH(&gScore[ahead]);                                             \
+                    PREFETCH(&h->pos[ahead]);                                             \
+                }                                                                         \
+                int v = targets[e];                                                       \
+                if (FILTER && !st->filter(u, v, st->edgeIDs ? st->edgeIDs[e] : e,         \
+                                          st->filterData))                                \
+                    continue;                                                             \
+                if (STATS)                                                                \
+                    st->stats->relaxed++;                                                 \
+                                                                                          \
+                dist_t tentative = distAdd(gScore[u], weights[e]);                        \
+                if (tentative >= gScore[v])                                               \
+                    continue;                                                             \
+                                                                                          \
+                gScore[v] = tentative;                                                    \
+                parent[v] = u;                                                            \
+                dist_t f = tentative;                                                     \
+                if (HEURISTIC)                                                            \
+                    f = distAdd(tentative, inflate(st->hCache[v], st->epsilon));          \
+                if (h->pos[v] == -1)                                                      \
+                    insertHeap(h, v, tentative, f);                                       \
+                else                                                                      \
+                    decreaseKey(h, v, tentative, f);                                      \
+            }                                                                             \
+            if (SEARCH_PREFETCH_DISTANCE > 0 && h->size > 0)                              \
+            {                                                                             \
+                int next = offsets[h->nodes[0].cityID];                                   \
+                PREFETCH(&targets[next]);                                                 \
+                PREFETCH(&weights[next]);                                                 \
+            }                                                                             \
+        }                                                                                 \
+    }
+
+DEFINE_SEARCH_KERNEL(searchKernel0000, 0, 0, 0, 0)
+DEFINE_SEARCH_KERNEL(searchKernel0001, 0, 0, 0, 1)
+DEFINE_SEARCH_KERNEL(searchKernel0010, 0, 0, 1, 0)
+DEFINE_SEARCH_KERNEL(searchKernel0011, 0, 0, 1, 1)
+DEFINE_SEARCH_KERNEL(searchKernel0100, 0, 1, 0, 0)
+DEFINE_SEARCH_KERNEL(searchKernel0101, 0, 1, 0, 1)
+DEFINE_SEARCH_KERNEL(searchKernel0110, 0, 1, 1, 0)
+DEFINE_SEARCH_KERNEL(searchKernel0111, 0, 1, 1, 1)
+DEFINE_SEARCH_KERNEL(searchKernel1000, 1, 0, 0, 0)
+DEFINE_SEARCH_KERNEL(searchKernel1001, 1, 0, 0, 1)
+DEFINE_SEARCH_KERNEL(searchKernel1010, 1, 0, 1, 0)
+DEFINE_SEARCH_KERNEL(searchKernel1011, 1, 0, 1, 1)
+DEFINE_SEARCH_KERNEL(searchKernel1100, 1, 1, 0, 0)
+DEFINE_SEARCH_KERNEL(searchKernel1101, 1, 1, 0, 1)
+DEFINE_SEARCH_KERNEL(searchKernel1110, 1, 1, 1, 0)
+DEFINE_SEARCH_KERNEL(searchKernel1111, 1, 1, 1, 1)
+
+/* Variant table, indexed by heuristic<<3 | earlyExit<<2 | filter<<1 | stats */
+static void (*const searchKernels[16])(SearchState *) = {
+    searchKernel0000, searchKernel0001, searchKernel0010, searchKernel0011,
+    searchKernel0100, searchKernel0101, searchKernel0110, searchKernel0111,
+    searchKernel1000, searchKernel1001, searchKernel1010, searchKernel1011,
+    searchKernel1100, searchKernel1101, searchKernel1110, searchKernel1111,
+};
+
+/* Fill options with plain Dijkstra defaults */
+void initSearchOptions(SearchOptions *opts)
+{
+    opts->epsilon = 0.0;
+    opts->fullTree = 0;
+    opts->reverse = 0;
+    opts->filter = NULL;
+    opts->filterData = NULL;
+    opts->stats = NULL;
+}
+
+/* Allocate a workspace; csr, gScore and parent are borrowed when given */
+static int openSearchState(SearchState *st, Graph *g, CSRGraph *csr, int withHeuristic,
+                           dist_t *gScore, int *parent)
+{
+    int n = g->numCities;
+
+    memset(st, 0, sizeof(*st));
+    st->n = n;
+    st->csr = csr ? csr : acquireCSR(g, &st->tempCSR);
+    st->h = createMinHeap(n);
+    st->ownScores = !gScore;
+    st->gScore = gScore ? gScore : (dist_t *)memAlloc(MEM_SEARCH, (n > 0 ? n : 1) * sizeof(dist_t));
+    st->parent = parent ? parent : (int *)memAlloc(MEM_SEARCH, (n > 0 ? n : 1) * sizeof(int));
+    if (withHeuristic)
+    {
+        st->hCache = (int *)memAlloc(MEM_SEARCH, (n > 0 ? n : 1) * sizeof(int));
+        st->pending = (int *)memAlloc(MEM_SEARCH, (n > 0 ? n : 1) * sizeof(int));
+        st->hBatch = (int *)memAlloc(MEM_SEARCH, (n > 0 ? n : 1) * sizeof(int));
+    }
+
+    if (!st->csr || !st->h || !st->gScore || !st->parent ||
+        (withHeuristic && (!st->hCache || !st->pending || !st->hBatch)))
+    {
+        printf("Error: Memory allocation failed!\n");
+        return 0;
+    }
+    return 1;
+}
+
+/* Free a workspace (closeSearchState on a failed open is fine) */
+static void closeSearchState(SearchState *st)
+{
+    releaseCSR(st->csr, st->tempCSR);
+    freeMinHeap(st->h);
+    if (st->ownScores)
+    {
+        memFree(st->gScore);
+        memFree(st->parent);
+    }
+    memFree(st->hCache);
+    memFree(st->pending);
+    memFree(st->hBatch);
+    memset(st, 0, sizeof(*st));
+}
+
+/* Reset the workspace for a search and put the source on the heap */
+static void prepareSearch(SearchState *st, int srcIndex, int destIndex,
+                          const SearchOptions *opts, SearchControl *ctl)
+{
+    int useHeuristic = opts->epsilon >= 1.0 && destIndex != -1 && st->hCache;
+
+    for (int i = 0; i < st->n; i++)
+    {
+        st->gScore[i] = INF;
+        st->parent[i] = -1;
+    }
+    // Leftovers from an early exit
+    for (int i = 0; i < st->h->size; i++)
+        st->h->pos[st->h->nodes[i].cityID] = -1;
+    st->h->size = 0;
+
+    // Transposed CSR: follow roads backwards, distances are *to* the source
+    int reverse = opts->reverse && destIndex == -1;
+    st->offsets = reverse ? st->csr->inOffsets : st->csr->offsets;
+    st->targets = reverse ? st->csr->sources : st->csr->targets;
+    st->weights = reverse ? st->csr->inWeights : st->csr->weights;
+    st->edgeIDs = reverse ? st->csr->inEdgeIDs : NULL;
+
+    st->gScore[srcIndex] = 0;
+    st->srcIndex = srcIndex;
+    st->destIndex = destIndex;
+    st->epsilon = opts->epsilon;
+    st->filter = opts->filter;
+    st->filterData = opts->filterData;
+    st->stats = opts->stats;
+    st->ctl = ctl;
+
+    dist_t f = 0;
+    if (useHeuristic)
+    {
+        for (int i = 0; i < st->n; i++)
+            st->hCache[i] = -1;
+        st->tx = st->csr->xs[destIndex];
+        st->ty = st->csr->ys[destIndex];
+        batchHeuristic(st->csr->xs, st->csr->ys, &srcIndex, 1, st->tx, st->ty,
+                       &st->hCache[srcIndex]);
+        f = inflate(st->hCache[srcIndex], st->epsilon);
+    }
+
+    st->variant = (useHeuristic << 3) | ((destIndex != -1 && !opts->fullTree) << 2) |
+                  ((opts->filter != NULL) << 1) | (opts->stats != NULL);
+    insertHeap(st->h, srcIndex, 0, f);
+}
+
+/* Reset the workspace and run the kernel variant for opts */
+static void startSearch(SearchState *st, int srcIndex, int destIndex,
+                        const SearchOptions *opts, SearchControl *ctl)
+{
+    prepareSearch(st, srcIndex, destIndex, opts, ctl);
+    beginSearch(ctl);
+    searchKernels[st->variant](st);
+}
+
+/* City settled: off the heap with a final distance */
+static int searchSettled(const SearchState *st, int index)
+{
+    return st->gScore[index] != INF && st->h->pos[index] == -1;
+}
+
+/* Continue an early-exit Dijkstra search (no heuristic) to a new target
+ * Everything settled so far stays valid; the previous target was settled
+ * but not expanded, so it goes back on the heap first */
+static void resumeSearch(SearchState *st, int destIndex)
+{
+    int last = st->destIndex;
+    if (last != -1 && searchSettled(st, last))
+        insertHeap(st->h, last, st->gScore[last], st->gScore[last]);
+
+    st->destIndex = destIndex;
+    searchKernels[st->variant](st);
+}
+
+/* Point-to-point search with a compile-time specialised kernel */
+PathResult *searchPath(Graph *g, int sourceCityID, int destCityID, const SearchOptions *opts,
+                       SearchControl *ctl)
+{
+    if (!g || !opts)
     {
         printf("Error: Invalid graph!\n");
         return NULL;
     }
 
+    if (opts->epsilon != 0.0 && opts->epsilon < 1.0)
+    {
+        printf("Error: Epsilon must be at least 1.0!\n");
+        return NULL;
+    }
+
     int srcIndex = findCityIndex(g, sourceCityID);
     int destIndex = findCityIndex(g, destCityID);
 
@@ -363,110 +1048,651 @@ PathResult *dijkstra(Graph *g, int sourceCityID, int destCityID)
         return NULL;
     }
 
-    int *dist = (int *)malloc(g->numCities * sizeof(int));
-    int *parent = (int *)malloc(g->numCities * sizeof(int));
+    SearchState st;
+    if (!openSearchState(&st, g, NULL, opts->epsilon >= 1.0, NULL, NULL))
+    {
+        closeSearchState(&st);
+        return NULL;
+    }
+    startSearch(&st, srcIndex, destIndex, opts, ctl);
 
-    if (!dist || !parent)
+    // Build path result - packed as the chain of city indices
+    PathResult *result;
+    if (searchStopped(ctl) || st.gScore[destIndex] == INF)
+    {
+        reportNoPath(ctl);
+        result = createPathResult(0);
+    }
+    else
+    {
+        result = packPath(g, st.parent, destIndex, st.gScore[destIndex]);
+    }
+
+    closeSearchState(&st);
+    return result;
+}
+
+/* Copy the path to a settled city out of the workspace */
+static int takeLeg(const SearchState *st, Graph *g, int destIndex, SearchControl *ctl,
+                   int **leg, int *length, dist_t *distance)
+{
+    if (searchStopped(ctl) || st->gScore[destIndex] == INF)
+        return 0;
+
+    int count = 0;
+    for (int c = destIndex; c != -1; c = st->parent[c])
+        count++;
+
+    *leg = (int *)memAlloc(MEM_SEARCH, count * sizeof(int));
+    if (!*leg)
     {
-        free(dist);
-        free(parent);
         printf("Error: Memory allocation failed!\n");
-        return NULL;
+        return 0;
     }
+    *length = count;
+    *distance = st->gScore[destIndex];
+    for (int c = destIndex; c != -1; c = st->parent[c])
+        (*leg)[--count] = g->cities[c].cityID;
+    return 1;
+}
 
-    // Initialize distances and parents
-    for (int i = 0; i < g->numCities; i++)
+/* Chained leg searches through ordered waypoints */
+PathResult *routeVia(Graph *g, const int *waypointIDs, int numWaypoints,
+                     const SearchOptions *opts, SearchControl *ctl)
+{
+    if (!g || !waypointIDs || numWaypoints < 2)
     {
-        dist[i] = INF;
-        parent[i] = -1;
+        printf("Error: A route needs at least two waypoints!\n");
+        return NULL;
     }
-    dist[srcIndex] = 0;
 
-    MinHeap *h = createMinHeap(g->numCities);
-    if (!h)
+    SearchOptions legOpts;
+    initSearchOptions(&legOpts);
+    legOpts.epsilon = 1.0;
+    if (opts)
+        legOpts = *opts;
+    legOpts.fullTree = 0;
+    if (legOpts.epsilon != 0.0 && legOpts.epsilon < 1.0)
     {
-        free(dist);
-        free(parent);
+        printf("Error: Epsilon must be at least 1.0!\n");
         return NULL;
     }
 
-    // Insert all cities into heap
-    for (int i = 0; i < g->numCities; i++)
+    int numLegs = numWaypoints - 1;
+    int *index = (int *)memAlloc(MEM_SEARCH, numWaypoints * sizeof(int));
+    int **legs = (int **)memCalloc(MEM_SEARCH, numLegs, sizeof(int *));
+    int *legLength = (int *)memCalloc(MEM_SEARCH, numLegs, sizeof(int));
+    dist_t *legDistance = (dist_t *)memCalloc(MEM_SEARCH, numLegs, sizeof(dist_t));
+    SearchState st;
+    memset(&st, 0, sizeof(st));
+    int ok = index && legs && legLength && legDistance;
+    if (!ok)
+        printf("Error: Memory allocation failed!\n");
+    else
+        ok = openSearchState(&st, g, NULL, legOpts.epsilon >= 1.0, NULL, NULL);
+
+    for (int i = 0; ok && i < numWaypoints; i++)
+    {
+        index[i] = findCityIndex(g, waypointIDs[i]);
+        if (index[i] == -1)
+        {
+            printf("Error: Waypoint city %d not found!\n", waypointIDs[i]);
+            ok = 0;
+        }
+    }
+    int valid = ok;
+
+    for (int s = 0; ok && s < numLegs; s++)
     {
-        insertHeap(h, g->cities[i].cityID, dist[i], dist[i]);
+        if (legs[s])
+            continue; // Taken by an earlier one-to-many search
+
+        int from = index[s];
+        int repeats = 0;
+        for (int k = s + 1; k < numLegs; k++)
+            repeats |= index[k] == from;
+
+        if (!repeats)
+        {
+            startSearch(&st, from, index[s + 1], &legOpts, ctl);
+            ok = takeLeg(&st, g, index[s + 1], ctl, &legs[s], &legLength[s], &legDistance[s]);
+            continue;
+        }
+
+        // One Dijkstra from this waypoint serves all of its legs
+        SearchOptions manyOpts = legOpts;
+        manyOpts.epsilon = 0.0;
+        startSearch(&st, from, index[s + 1], &manyOpts, ctl);
+        for (int k = s; ok && k < numLegs; k++)
+        {
+            if (index[k] != from)
+                continue;
+            int to = index[k + 1];
+            if (!searchSettled(&st, to) && !searchStopped(ctl))
+                resumeSearch(&st, to);
+            ok = takeLeg(&st, g, to, ctl, &legs[k], &legLength[k], &legDistance[k]);
+        }
     }
+    closeSearchState(&st);
 
-    // Dijkstra's algorithm
-    while (!isHeapEmpty(h))
+    // Concatenate, dropping each leg's first city (the previous leg's last)
+    PathResult *result = NULL;
+    if (ok)
     {
-        HeapNode minNode = extractMin(h);
-        int u = findCityIndex(g, minNode.cityID);
+        int total = 1;
+        for (int s = 0; s < numLegs; s++)
+            total += legLength[s] - 1;
 
-        if (u == destIndex)
+        result = createPathResult(total);
+        if (result)
+        {
+            result->segmentEnds = (int *)memAlloc(MEM_SEARCH, numLegs * sizeof(int));
+            result->segmentDistances = (dist_t *)memAlloc(MEM_SEARCH, numLegs * sizeof(dist_t));
+        }
+        if (result && result->segmentEnds && result->segmentDistances)
+        {
+            result->path[result->pathLength++] = legs[0][0];
+            for (int s = 0; s < numLegs; s++)
+            {
+                memcpy(result->path + result->pathLength, legs[s] + 1,
+                       (legLength[s] - 1) * sizeof(int));
+                result->pathLength += legLength[s] - 1;
+                result->totalDistance = distAdd(result->totalDistance, legDistance[s]);
+                result->segmentEnds[s] = result->pathLength - 1;
+                result->segmentDistances[s] = legDistance[s];
+            }
+            result->numSegments = numLegs;
+        }
+        else
+        {
+            printf("Error: Memory allocation failed!\n");
+            freePathResult(result);
+            result = NULL;
+        }
+    }
+    else if (valid)
+    {
+        reportNoPath(ctl);
+        result = createPathResult(0);
+    }
+
+    for (int s = 0; legs && s < numLegs; s++)
+        memFree(legs[s]);
+    memFree(index);
+    memFree(legs);
+    memFree(legLength);
+    memFree(legDistance);
+    return result;
+}
+
+/* Dijkstra from one source to every reachable city, or with opts->reverse
+ * from every city that reaches it */
+int shortestPathTree(Graph *g, int sourceCityID, const SearchOptions *opts,
+                     dist_t *dist, int *parent, SearchControl *ctl)
+{
+    if (!g || !dist || !parent)
+    {
+        printf("Error: Invalid parameters!\n");
+        return 0;
+    }
+
+    int srcIndex = findCityIndex(g, sourceCityID);
+    if (srcIndex == -1)
+    {
+        printf("Error: Source city not found!\n");
+        return 0;
+    }
+
+    SearchOptions treeOpts;
+    initSearchOptions(&treeOpts);
+    if (opts)
+        treeOpts = *opts;
+    treeOpts.epsilon = 0.0;
+    treeOpts.fullTree = 1;
+
+    SearchState st;
+    int ok = openSearchState(&st, g, NULL, 0, dist, parent);
+    // A reverse tree needs the transposed half, which the cache may lack
+    if (ok && treeOpts.reverse && !st.csr->inOffsets)
+    {
+        releaseCSR(st.csr, st.tempCSR);
+        st.csr = acquireTransposedCSR(g, &st.tempCSR);
+        ok = st.csr != NULL;
+    }
+    if (ok)
+        startSearch(&st, srcIndex, -1, &treeOpts, ctl);
+    closeSearchState(&st);
+    return ok && !searchStopped(ctl);
+}
+
+// INTERLEAVED BATCH SEARCH
+/* One in-flight query of a batch */
+typedef struct BatchSlot
+{
+    SearchState st;
+    int query;          // Index into the batch, -1 when idle
+    int u;              // City being settled this round
+} BatchSlot;
+
+/* Shared state of a searchBatch call */
+typedef struct BatchSearch
+{
+    Graph *g;
+    const int *sourceIDs;
+    const int *destIDs;
+    int numQueries;
+    int nextQuery;      // Next query to hand to an idle slot
+    const SearchOptions *opts;
+    SearchControl *ctl;
+    dist_t *distances;
+    PathResult **paths;
+} BatchSearch;
+
+/* Record a slot's result */
+static void finishBatchQuery(BatchSearch *b, BatchSlot *slot)
+{
+    SearchState *st = &slot->st;
+    dist_t d = st->gScore[st->destIndex];
+    b->distances[slot->query] = d;
+    if (b->paths)
+    {
+        if (d == INF)
+        {
+            b->paths[slot->query] = createPathResult(0);
+        }
+        else
+        {
+            b->paths[slot->query] = packPath(b->g, st->parent, st->destIndex, d);
+        }
+    }
+    slot->query = -1;
+}
+
+/* Give an idle slot the next query with known cities; unknown ones
+ * are answered as unreachable */
+static void loadBatchQuery(BatchSearch *b, BatchSlot *slot)
+{
+    while (b->nextQuery < b->numQueries)
+    {
+        int q = b->nextQuery++;
+        int srcIndex = findCityIndex(b->g, b->sourceIDs[q]);
+        int destIndex = findCityIndex(b->g, b->destIDs[q]);
+        if (srcIndex != -1 && destIndex != -1)
+        {
+            prepareSearch(&slot->st, srcIndex, destIndex, b->opts, b->ctl);
+            slot->query = q;
+            return;
+        }
+        b->distances[q] = INF;
+        if (b->paths)
+            b->paths[q] = createPathResult(0);
+    }
+}
+
+/* Interleaved point-to-point searches */
+int searchBatch(Graph *g, const int *sourceIDs, const int *destIDs, int numQueries,
+                const SearchOptions *opts, dist_t *distances, PathResult **paths,
+                SearchControl *ctl)
+{
+    if (!g || !sourceIDs || !destIDs || !opts || !distances || numQueries < 0)
+    {
+        printf("Error: Invalid parameters!\n");
+        return 0;
+    }
+    if (opts->epsilon != 0.0 && opts->epsilon < 1.0)
+    {
+        printf("Error: Epsilon must be at least 1.0!\n");
+        return 0;
+    }
+    for (int q = 0; q < numQueries; q++)
+    {
+        distances[q] = INF;
+        if (paths)
+            paths[q] = NULL;
+    }
+
+    // One snapshot shared by every slot
+    int tempCSR;
+    CSRGraph *csr = acquireCSR(g, &tempCSR);
+    int width = numQueries < SEARCH_BATCH_WIDTH ? numQueries : SEARCH_BATCH_WIDTH;
+    BatchSlot *slots = (BatchSlot *)memCalloc(MEM_SEARCH, width > 0 ? width : 1, sizeof(BatchSlot));
+    int ok = csr && slots;
+    for (int i = 0; ok && i < width; i++)
+    {
+        ok = openSearchState(&slots[i].st, g, csr, opts->epsilon >= 1.0, NULL, NULL);
+        slots[i].query = -1;
+    }
+
+    BatchSearch b = {g, sourceIDs, destIDs, numQueries, 0, opts, ctl, distances, paths};
+    int heuristic = opts->epsilon >= 1.0;
+    beginSearch(ctl);
+    int active = ok ? width : 0;
+    while (active > 0)
+    {
+        // Each stage issues its loads for every slot before the next stage
+        // uses them, so the cache misses of the group overlap
+        // 1. Next city of each search; finished searches take a new query
+        active = 0;
+        for (int i = 0; i < width; i++)
+        {
+            BatchSlot *slot = &slots[i];
+            slot->u = -1;
+            while (slot->u == -1 && ok)
+            {
+                if (slot->query == -1)
+                {
+                    loadBatchQuery(&b, slot);
+                    if (slot->query == -1)
+                        break;
+                }
+                SearchState *st = &slot->st;
+                if (isHeapEmpty(st->h))
+                {
+                    finishBatchQuery(&b, slot);
+                    continue;
+                }
+                int u = extractMin(st->h).cityID;
+                if (st->stats)
+                    st->stats->settled++;
+                if (u == st->destIndex)
+                {
+                    finishBatchQuery(&b, slot);
+                    continue;
+                }
+                slot->u = u;
+                PREFETCH(&st->offsets[u]);
+                active++;
+            }
+        }
+        if (!ok)
             break;
 
-        Edge *edge = g->cities[u].adjList;
-        while (edge)
+        // 2. Their adjacency rows
+        for (int i = 0; i < width; i++)
         {
-            int v = findCityIndex(g, edge->destCityID);
+            if (slots[i].u == -1)
+                continue;
+            int first = slots[i].st.offsets[slots[i].u];
+            PREFETCH(&slots[i].st.targets[first]);
+            PREFETCH(&slots[i].st.weights[first]);
+        }
 
-            if (dist[u] != INF && dist[u] + edge->distance < dist[v])
+        // 3. The neighbours' scores, heap slots and heuristics
+        for (int i = 0; i < width; i++)
+        {
+            SearchState *st = &slots[i].st;
+            int u = slots[i].u;
+            if (u == -1)
+                continue;
+            for (int e = st->offsets[u]; e < st->offsets[u + 1]; e++)
             {
-                dist[v] = dist[u] + edge->distance;
-                parent[v] = u;
-                decreaseKey(h, edge->destCityID, dist[v], dist[v]);
+                int v = st->targets[e];
+                PREFETCH(&st->gScore[v]);
+                PREFETCH(&st->h->pos[v]);
+                if (heuristic)
+                    PREFETCH(&st->hCache[v]);
+            }
+        }
+
+        // 4. Relax
+        for (int i = 0; i < width && active > 0; i++)
+        {
+            SearchState *st = &slots[i].st;
+            int u = slots[i].u;
+            if (u == -1)
+                continue;
+            const int *targets = st->targets;
+            const int *weights = st->weights;
+            dist_t *gScore = st->gScore;
+            MinHeap *h = st->h;
+            int first = st->offsets[u], end = st->offsets[u + 1];
+            if (searchShouldStop(ctl, end - first + 1))
+            {
+                active = 0;
+                break;
+            }
+            if (heuristic)
+                evaluateNeighbourHeuristics(st->csr, u, st->hCache, st->pending, st->hBatch,
+                                            st->tx, st->ty);
+            for (int e = first; e < end; e++)
+            {
+                int v = targets[e];
+                if (st->filter && !st->filter(u, v, e, st->filterData))
+                    continue;
+                if (st->stats)
+                    st->stats->relaxed++;
+
+                dist_t tentative = distAdd(gScore[u], weights[e]);
+                if (tentative >= gScore[v])
+                    continue;
+
+                gScore[v] = tentative;
+                st->parent[v] = u;
+                dist_t f = tentative;
+                if (heuristic)
+                    f = distAdd(tentative, inflate(st->hCache[v], st->epsilon));
+                if (h->pos[v] == -1)
+                    insertHeap(h, v, tentative, f);
+                else
+                    decreaseKey(h, v, tentative, f);
             }
-            edge = edge->next;
         }
     }
+    if (!ok)
+        printf("Error: Memory allocation failed!\n");
 
-    freeMinHeap(h);
+    // Stopped early: unanswered queries stay INF, with empty paths
+    for (int q = 0; paths && q < numQueries; q++)
+    {
+        if (!paths[q])
+            paths[q] = createPathResult(0);
+    }
+    for (int i = 0; slots && i < width; i++)
+        closeSearchState(&slots[i].st);
+    memFree(slots);
+    releaseCSR(csr, tempCSR);
+    return ok && !searchStopped(ctl);
+}
 
-    // Build path result
-    PathResult *result = createPathResult(g->numCities);
-    if (!result)
+// AVOID SETS
+/* Empty avoid set sized for the graph */
+AvoidSet *createAvoidSet(Graph *g)
+{
+    if (!g)
     {
-        free(dist);
-        free(parent);
+        printf("Error: Invalid graph!\n");
         return NULL;
     }
 
-    if (dist[destIndex] == INF)
+    int tempCSR;
+    CSRGraph *csr = acquireCSR(g, &tempCSR);
+    AvoidSet *avoid = (AvoidSet *)memCalloc(MEM_SEARCH, 1, sizeof(AvoidSet));
+    if (!csr || !avoid)
     {
-        printf("No path exists between these cities!\n");
-        free(dist);
-        free(parent);
-        return result;
+        releaseCSR(csr, tempCSR);
+        memFree(avoid);
+        printf("Error: Memory allocation failed!\n");
+        return NULL;
     }
 
-    result->totalDistance = dist[destIndex];
+    avoid->numCities = g->numCities;
+    avoid->numRoads = csr->numEdges;
+    avoid->graphVersion = g->version;
+    releaseCSR(csr, tempCSR);
 
-    // Trace path back from destination to source
-    int current = destIndex;
-    while (current != -1)
+    avoid->cities = (uint64_t *)memCalloc(MEM_SEARCH, avoid->numCities / 64 + 1, sizeof(uint64_t));
+    avoid->roads = (uint64_t *)memCalloc(MEM_SEARCH, avoid->numRoads / 64 + 1, sizeof(uint64_t));
+    if (!avoid->cities || !avoid->roads)
     {
-        addToPath(result, g->cities[current].cityID);
-        current = parent[current];
+        freeAvoidSet(avoid);
+        printf("Error: Memory allocation failed!\n");
+        return NULL;
     }
-    reversePath(result);
+    return avoid;
+}
+
+/* Free avoid set */
+void freeAvoidSet(AvoidSet *avoid)
+{
+    if (!avoid)
+        return;
+    memFree(avoid->cities);
+    memFree(avoid->roads);
+    memFree(avoid);
+}
 
-    free(dist);
-    free(parent);
+/* Set the bit of a city */
+int avoidCity(AvoidSet *avoid, Graph *g, int cityID)
+{
+    int index = findCityIndex(g, cityID);
+    if (!avoid || index == -1 || index >= avoid->numCities)
+        return 0;
 
-    return result;
+    avoid->cities[index >> 6] |= 1ULL << (index & 63);
+    return 1;
+}
+
+/* Set the bits of all parallel roads from -> to */
+int avoidRoad(AvoidSet *avoid, Graph *g, int fromCityID, int toCityID)
+{
+    int from = findCityIndex(g, fromCityID);
+    int to = findCityIndex(g, toCityID);
+    if (!avoid || from == -1 || to == -1)
+        return 0;
+
+    int tempCSR, found = 0;
+    CSRGraph *csr = acquireCSR(g, &tempCSR);
+    if (!csr)
+        return 0;
+
+    for (int e = csr->offsets[from]; e < csr->offsets[from + 1]; e++)
+    {
+        if (csr->targets[e] == to && e < avoid->numRoads)
+        {
+            avoid->roads[e >> 6] |= 1ULL << (e & 63);
+            found = 1;
+        }
+    }
+    releaseCSR(csr, tempCSR);
+    return found;
+}
+
+/* Edge filter: reject avoided roads and roads into avoided cities */
+static int avoidFilter(int fromIndex, int toIndex, int edgeIndex, void *userData)
+{
+    const AvoidSet *avoid = (const AvoidSet *)userData;
+    (void)fromIndex;
+    return !((avoid->cities[toIndex >> 6] >> (toIndex & 63)) & 1) &&
+           !((avoid->roads[edgeIndex >> 6] >> (edgeIndex & 63)) & 1);
+}
+
+/* Point the options' filter at the avoid set */
+int setAvoidFilter(SearchOptions *opts, const AvoidSet *avoid, Graph *g)
+{
+    if (!avoid)
+    {
+        opts->filter = NULL;
+        opts->filterData = NULL;
+        return 1;
+    }
+
+    if (!g || g->version != avoid->graphVersion)
+    {
+        printf("Error: Graph changed since the avoid set was built!\n");
+        return 0;
+    }
+
+    opts->filter = avoidFilter;
+    opts->filterData = (void *)avoid;
+    return 1;
+}
+
+// DIJKSTRA'S ALGORITHM
+/*Dijkstra's shortest path algorithm */
+PathResult *dijkstra(Graph *g, int sourceCityID, int destCityID, SearchControl *ctl)
+{
+    SearchOptions opts;
+    initSearchOptions(&opts);
+    return searchPath(g, sourceCityID, destCityID, &opts, ctl);
 }
 
 // A* ALGORITHM
-/* Heuristic function - Euclidean distance */
-int heuristic(Graph *g, int cityIndex1, int cityIndex2)
+/* Unpacked PathResult copied out of parent indices that will keep changing */
+static PathResult *pathFromParents(Graph *g, const int *parent, int destIndex, dist_t distance)
 {
-    int dx = g->cities[cityIndex1].x - g->cities[cityIndex2].x;
-    int dy = g->cities[cityIndex1].y - g->cities[cityIndex2].y;
-    return (int)sqrt(dx * dx + dy * dy);
+    int length = 0;
+    for (int current = destIndex; current != -1; current = parent[current])
+        length++;
+
+    PathResult *result = createPathResult(length);
+    if (!result)
+        return NULL;
+
+    result->totalDistance = distance;
+    result->pathLength = length;
+    for (int current = destIndex; current != -1; current = parent[current])
+        result->path[--length] = g->cities[current].cityID;
+    return result;
 }
 
 /* A* shortest path algorithm */
-PathResult *astar(Graph *g, int sourceCityID, int destCityID)
+PathResult *astar(Graph *g, int sourceCityID, int destCityID, SearchControl *ctl)
+{
+    return astarWeighted(g, sourceCityID, destCityID, 1.0, ctl);
+}
+
+/* Weighted A* - f = g + epsilon * h */
+PathResult *astarWeighted(Graph *g, int sourceCityID, int destCityID, double epsilon,
+                          SearchControl *ctl)
+{
+    if (epsilon < 1.0)
+    {
+        printf("Error: Epsilon must be at least 1.0!\n");
+        return NULL;
+    }
+
+    SearchOptions opts;
+    initSearchOptions(&opts);
+    opts.epsilon = epsilon;
+    return searchPath(g, sourceCityID, destCityID, &opts, ctl);
+}
+
+// ANYTIME A* (ARA*)
+/* Rebuild the open heap with keys for a new epsilon, merging INCONS into OPEN */
+static void rekeyOpenList(MinHeap *h, const dist_t *gScore, const int *hCache,
+                          int *incons, int *numIncons, int *inInc, double epsilon)
+{
+    int count = h->size;
+    HeapNode *old = (HeapNode *)memAlloc(MEM_SEARCH, (count > 0 ? count : 1) * sizeof(HeapNode));
+    if (!old)
+        return;
+    memcpy(old, h->nodes, count * sizeof(HeapNode));
+
+    for (int i = 0; i < count; i++)
+        h->pos[old[i].cityID] = -1;
+    h->size = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        int v = old[i].cityID;
+        insertHeap(h, v, gScore[v], distAdd(gScore[v], inflate(hCache[v], epsilon)));
+    }
+    for (int i = 0; i < *numIncons; i++)
+    {
+        int v = incons[i];
+        inInc[v] = 0;
+        if (h->pos[v] == -1)
+            insertHeap(h, v, gScore[v], distAdd(gScore[v], inflate(hCache[v], epsilon)));
+    }
+    *numIncons = 0;
+    memFree(old);
+}
+
+/* Anytime repairing A* - improving series of paths until deadline */
+PathResult *astarAnytime(Graph *g, int sourceCityID, int destCityID, double epsilon,
+                         double epsilonStep, double deadlineMs,
+                         AnytimePathCallback onImprove, void *userData,
+                         SearchControl *ctl)
 {
     if (!g)
     {
@@ -474,6 +1700,12 @@ PathResult *astar(Graph *g, int sourceCityID, int destCityID)
         return NULL;
     }
 
+    if (epsilon < 1.0 || epsilonStep <= 0.0)
+    {
+        printf("Error: Epsilon must be at least 1.0 with a positive step!\n");
+        return NULL;
+    }
+
     int srcIndex = findCityIndex(g, sourceCityID);
     int destIndex = findCityIndex(g, destCityID);
 
@@ -483,112 +1715,499 @@ PathResult *astar(Graph *g, int sourceCityID, int destCityID)
         return NULL;
     }
 
-    int *gScore = (int *)malloc(g->numCities * sizeof(int));
-    int *fScore = (int *)malloc(g->numCities * sizeof(int));
-    int *parent = (int *)malloc(g->numCities * sizeof(int));
-
-    if (!gScore || !fScore || !parent)
+    double start = currentTimeMs();
+    int n = g->numCities;
+    int tempCSR;
+    CSRGraph *csr = acquireCSR(g, &tempCSR);
+    dist_t *gScore = (dist_t *)memAlloc(MEM_SEARCH, n * sizeof(dist_t));
+    int *parent = (int *)memAlloc(MEM_SEARCH, n * sizeof(int));
+    int *hCache = (int *)memAlloc(MEM_SEARCH, n * sizeof(int));
+    int *pending = (int *)memAlloc(MEM_SEARCH, n * sizeof(int));
+    int *hBatch = (int *)memAlloc(MEM_SEARCH, n * sizeof(int));
+    int *closed = (int *)memAlloc(MEM_SEARCH, n * sizeof(int));
+    int *inInc = (int *)memCalloc(MEM_SEARCH, n, sizeof(int));   // Membership in INCONS
+    int *incons = (int *)memAlloc(MEM_SEARCH, n * sizeof(int)); // Closed cities improved in this pass
+    MinHeap *h = createMinHeap(n);
+
+    if (!csr || !gScore || !parent || !hCache || !pending || !hBatch ||
+        !closed || !inInc || !incons || !h)
     {
-        free(gScore);
-        free(fScore);
-        free(parent);
+        releaseCSR(csr, tempCSR);
+        memFree(gScore);
+        memFree(parent);
+        memFree(hCache);
+        memFree(pending);
+        memFree(hBatch);
+        memFree(closed);
+        memFree(inInc);
+        memFree(incons);
+        freeMinHeap(h);
         printf("Error: Memory allocation failed!\n");
         return NULL;
     }
 
-    // Initialize scores
-    for (int i = 0; i < g->numCities; i++)
+    for (int i = 0; i < n; i++)
     {
         gScore[i] = INF;
-        fScore[i] = INF;
         parent[i] = -1;
+        hCache[i] = -1;
     }
 
+    float tx = csr->xs[destIndex];
+    float ty = csr->ys[destIndex];
+    int numIncons = 0;
+
     gScore[srcIndex] = 0;
-    fScore[srcIndex] = heuristic(g, srcIndex, destIndex);
+    batchHeuristic(csr->xs, csr->ys, &srcIndex, 1, tx, ty, &hCache[srcIndex]);
+    insertHeap(h, srcIndex, 0, inflate(hCache[srcIndex], epsilon));
 
-    MinHeap *h = createMinHeap(g->numCities);
-    if (!h)
+    PathResult *best = NULL;
+    int expansions = 0;
+    beginSearch(ctl);
+    int pass = 0;
+
+    for (;;)
     {
-        free(gScore);
-        free(fScore);
-        free(parent);
-        return NULL;
+        // ImprovePath: expand while the goal is not provably within epsilon
+        int expired = 0;
+        memset(closed, 0, n * sizeof(int));
+        while (!isHeapEmpty(h) && gScore[destIndex] > h->nodes[0].fScore)
+        {
+            // The first pass always completes so there is an answer to return
+            if (pass > 0 && (++expansions & 63) == 0 && currentTimeMs() - start >= deadlineMs)
+            {
+                expired = 1;
+                break;
+            }
+
+            int u = h->nodes[0].cityID;
+            if (searchShouldStop(ctl, csr->offsets[u + 1] - csr->offsets[u] + 1))
+            {
+                expired = 1;
+                break;
+            }
+
+            extractMin(h);
+            closed[u] = 1;
+            evaluateNeighbourHeuristics(csr, u, hCache, pending, hBatch, tx, ty);
+
+            for (int e = csr->offsets[u]; e < csr->offsets[u + 1]; e++)
+            {
+                int v = csr->targets[e];
+                dist_t tentative = distAdd(gScore[u], csr->weights[e]);
+                if (tentative >= gScore[v])
+                    continue;
+
+                gScore[v] = tentative;
+                parent[v] = u;
+                if (!closed[v])
+                {
+                    dist_t f = distAdd(tentative, inflate(hCache[v], epsilon));
+                    if (h->pos[v] == -1)
+                        insertHeap(h, v, tentative, f);
+                    else
+                        decreaseKey(h, v, tentative, f);
+                }
+                else if (!inInc[v])
+                {
+                    inInc[v] = 1;
+                    incons[numIncons++] = v;
+                }
+            }
+        }
+
+        if (expired || gScore[destIndex] == INF)
+            break;
+
+        // Publish the improved solution
+        PathResult *pr = pathFromParents(g, parent, destIndex, gScore[destIndex]);
+        if (pr)
+        {
+            if (best && pr->totalDistance >= best->totalDistance)
+            {
+                freePathResult(pr);
+            }
+            else
+            {
+                freePathResult(best);
+                best = pr;
+                if (onImprove)
+                    onImprove(best, epsilon, userData);
+            }
+        }
+
+        if (epsilon <= 1.0 || currentTimeMs() - start >= deadlineMs || searchStopped(ctl))
+            break;
+
+        epsilon -= epsilonStep;
+        if (epsilon < 1.0)
+            epsilon = 1.0;
+        rekeyOpenList(h, gScore, hCache, incons, &numIncons, inInc, epsilon);
+        pass++;
     }
 
-    insertHeap(h, g->cities[srcIndex].cityID, gScore[srcIndex], fScore[srcIndex]);
+    releaseCSR(csr, tempCSR);
+    memFree(gScore);
+    memFree(parent);
+    memFree(hCache);
+    memFree(pending);
+    memFree(hBatch);
+    memFree(closed);
+    memFree(inInc);
+    memFree(incons);
+    freeMinHeap(h);
 
-    // A* algorithm
-    while (!isHeapEmpty(h))
+    if (!best)
     {
-        HeapNode minNode = extractMin(h);
-        int u = findCityIndex(g, minNode.cityID);
+        reportNoPath(ctl);
+        best = createPathResult(0);
+    }
+    return best;
+}
 
-        if (u == destIndex)
-            break; // Reached destination
+// GRAPH STATISTICS
+/* Per-thread share of the scan: a city index range and its partial stats */
+typedef struct StatsWorker {
+    Graph *g;
+    const CSRGraph *csr;
+    int begin;
+    int end;
+    int *seen;          // Row stamp per target, for duplicates on long rows
+    GraphStats part;
+    pthread_t thread;
+} StatsWorker;
+
+static int degreeBucket(int degree)
+{
+    return degree < STATS_DEGREE_BUCKETS - 1 ? degree : STATS_DEGREE_BUCKETS - 1;
+}
 
-        Edge *edge = g->cities[u].adjList;
-        while (edge)
-        {
-            int v = findCityIndex(g, edge->destCityID);
-            int tentative_gScore = gScore[u] + edge->distance;
+/* floor(log2(weight)) + 1, so 0 has a bucket of its own */
+static int weightBucket(int weight)
+{
+    int b = 0;
+    while (weight > 0 && b < STATS_WEIGHT_BUCKETS - 1)
+    {
+        weight >>= 1;
+        b++;
+    }
+    return b;
+}
 
-            if (tentative_gScore < gScore[v])
+/* Scan one city range: degrees, weights, self-loops, duplicates, bounds */
+static void *statsWorkerMain(void *arg)
+{
+    StatsWorker *w = (StatsWorker *)arg;
+    const CSRGraph *csr = w->csr;
+    GraphStats *p = &w->part;
+
+    for (int i = w->begin; i < w->end; i++)
+    {
+        int first = csr->offsets[i], last = csr->offsets[i + 1];
+        int out = last - first;
+        int in = csr->inOffsets[i + 1] - csr->inOffsets[i];
+        p->outDegree[degreeBucket(out)]++;
+        p->inDegree[degreeBucket(in)]++;
+        if (out > p->maxOutDegree)
+            p->maxOutDegree = out;
+        if (in > p->maxInDegree)
+            p->maxInDegree = in;
+
+        // Short rows compare pairwise; long ones stamp their targets
+        if (out > 32 && !w->seen)
+        {
+            w->seen = (int *)memAlloc(MEM_SEARCH, csr->numCities * sizeof(int));
+            for (int k = 0; w->seen && k < csr->numCities; k++)
+                w->seen[k] = -1;
+        }
+        for (int e = first; e < last; e++)
+        {
+            int t = csr->targets[e], weight = csr->weights[e];
+            if (t == i)
+                p->selfLoops++;
+            if (out > 32 && w->seen)
             {
-                parent[v] = u;
-                gScore[v] = tentative_gScore;
-                fScore[v] = gScore[v] + heuristic(g, v, destIndex);
+                if (w->seen[t] == i)
+                    p->duplicates++;
+                w->seen[t] = i;
+            }
+            else
+            {
+                for (int f = first; f < e; f++)
+                {
+                    if (csr->targets[f] == t)
+                    {
+                        p->duplicates++;
+                        break;
+                    }
+                }
+            }
+
+            p->weights[weightBucket(weight)]++;
+            p->totalWeight += weight;
+            if (p->numEdges == 0 || weight < p->minWeight)
+                p->minWeight = weight;
+            if (weight > p->maxWeight)
+                p->maxWeight = weight;
+            p->numEdges++;
+        }
+
+        City *c = &w->g->cities[i];
+        if (p->numCities == 0 || c->x < p->minX)
+            p->minX = c->x;
+        if (p->numCities == 0 || c->y < p->minY)
+            p->minY = c->y;
+        if (p->numCities == 0 || c->x > p->maxX)
+            p->maxX = c->x;
+        if (p->numCities == 0 || c->y > p->maxY)
+            p->maxY = c->y;
+        p->numCities++;
+    }
+    return NULL;
+}
 
-                if (h->pos[edge->destCityID] == -1)
+/* Fold a worker's partial stats into the total */
+static void mergeStats(GraphStats *total, const GraphStats *p)
+{
+    if (p->numCities == 0)
+        return;
+
+    for (int b = 0; b < STATS_DEGREE_BUCKETS; b++)
+    {
+        total->inDegree[b] += p->inDegree[b];
+        total->outDegree[b] += p->outDegree[b];
+    }
+    for (int b = 0; b < STATS_WEIGHT_BUCKETS; b++)
+        total->weights[b] += p->weights[b];
+    if (p->maxInDegree > total->maxInDegree)
+        total->maxInDegree = p->maxInDegree;
+    if (p->maxOutDegree > total->maxOutDegree)
+        total->maxOutDegree = p->maxOutDegree;
+    if (p->numEdges > 0 && (total->numEdges == 0 || p->minWeight < total->minWeight))
+        total->minWeight = p->minWeight;
+    if (p->maxWeight > total->maxWeight)
+        total->maxWeight = p->maxWeight;
+    if (total->numCities == 0 || p->minX < total->minX)
+        total->minX = p->minX;
+    if (total->numCities == 0 || p->minY < total->minY)
+        total->minY = p->minY;
+    if (total->numCities == 0 || p->maxX > total->maxX)
+        total->maxX = p->maxX;
+    if (total->numCities == 0 || p->maxY > total->maxY)
+        total->maxY = p->maxY;
+    total->totalWeight += p->totalWeight;
+    total->selfLoops += p->selfLoops;
+    total->duplicates += p->duplicates;
+    total->numEdges += p->numEdges;
+    total->numCities += p->numCities;
+}
+
+/* Tarjan's strongly connected components, iterative; 0 on allocation failure */
+static int countComponents(const CSRGraph *csr, int *numComponents, int *largest)
+{
+    int n = csr->numCities;
+    int *order = (int *)memAlloc(MEM_SEARCH, (n > 0 ? n : 1) * sizeof(int));
+    int *low = (int *)memAlloc(MEM_SEARCH, (n > 0 ? n : 1) * sizeof(int));
+    int *stack = (int *)memAlloc(MEM_SEARCH, (n > 0 ? n : 1) * sizeof(int));
+    int *calls = (int *)memAlloc(MEM_SEARCH, (n > 0 ? n : 1) * sizeof(int));
+    int *next = (int *)memAlloc(MEM_SEARCH, (n > 0 ? n : 1) * sizeof(int));
+    char *onStack = (char *)memCalloc(MEM_SEARCH, n > 0 ? n : 1, 1);
+
+    if (!order || !low || !stack || !calls || !next || !onStack)
+    {
+        memFree(order);
+        memFree(low);
+        memFree(stack);
+        memFree(calls);
+        memFree(next);
+        memFree(onStack);
+        return 0;
+    }
+
+    for (int i = 0; i < n; i++)
+        order[i] = -1;
+
+    int counter = 0, sp = 0;
+    *numComponents = 0;
+    *largest = 0;
+
+    for (int root = 0; root < n; root++)
+    {
+        if (order[root] != -1)
+            continue;
+
+        int cp = 0;
+        order[root] = low[root] = counter++;
+        stack[sp++] = root;
+        onStack[root] = 1;
+        next[root] = csr->offsets[root];
+        calls[cp++] = root;
+
+        while (cp > 0)
+        {
+            int v = calls[cp - 1];
+            if (next[v] < csr->offsets[v + 1])
+            {
+                int w = csr->targets[next[v]++];
+                if (order[w] == -1)
                 {
-                    insertHeap(h, edge->destCityID, gScore[v], fScore[v]);
+                    order[w] = low[w] = counter++;
+                    stack[sp++] = w;
+                    onStack[w] = 1;
+                    next[w] = csr->offsets[w];
+                    calls[cp++] = w;
                 }
-                else
+                else if (onStack[w] && order[w] < low[v])
                 {
-                    decreaseKey(h, edge->destCityID, gScore[v], fScore[v]);
+                    low[v] = order[w];
                 }
+                continue;
+            }
+
+            // v is finished: pass its low link up, pop its component if it is a root
+            cp--;
+            if (cp > 0 && low[v] < low[calls[cp - 1]])
+                low[calls[cp - 1]] = low[v];
+            if (low[v] == order[v])
+            {
+                int size = 0, w;
+                do
+                {
+                    w = stack[--sp];
+                    onStack[w] = 0;
+                    size++;
+                } while (w != v);
+                (*numComponents)++;
+                if (size > *largest)
+                    *largest = size;
             }
-            edge = edge->next;
         }
     }
 
-    freeMinHeap(h);
+    memFree(order);
+    memFree(low);
+    memFree(stack);
+    memFree(calls);
+    memFree(next);
+    memFree(onStack);
+    return 1;
+}
 
-    // Build path result
-    PathResult *result = createPathResult(g->numCities);
-    if (!result)
+/* Graph statistics - parallel CSR scan, SCCs on the calling thread */
+int graphStats(Graph *g, GraphStats *stats, int numThreads)
+{
+    if (!g || !stats)
     {
-        free(gScore);
-        free(fScore);
-        free(parent);
-        return NULL;
+        printf("Error: Invalid parameters!\n");
+        return 0;
     }
 
-    if (gScore[destIndex] == INF)
+    double start = currentTimeMs();
+    int tempCSR;
+    CSRGraph *csr = acquireTransposedCSR(g, &tempCSR);
+    if (!csr)
+        return 0;
+
+    int n = csr->numCities;
+    if (numThreads <= 0)
     {
-        printf("No path exists between these cities!\n");
-        free(gScore);
-        free(fScore);
-        free(parent);
-        return result;
+#if defined(_SC_NPROCESSORS_ONLN)
+        numThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#else
+        numThreads = 1;
+#endif
+    }
+    if (numThreads > STATS_MAX_THREADS)
+        numThreads = STATS_MAX_THREADS;
+    if (numThreads > n / STATS_MIN_CITIES_PER_THREAD)
+        numThreads = n / STATS_MIN_CITIES_PER_THREAD;
+    if (numThreads < 1)
+        numThreads = 1;
+
+    StatsWorker *workers = (StatsWorker *)memCalloc(MEM_SEARCH, numThreads, sizeof(StatsWorker));
+    int *started = (int *)memCalloc(MEM_SEARCH, numThreads, sizeof(int));
+    if (!workers || !started)
+    {
+        printf("Error: Memory allocation failed!\n");
+        memFree(workers);
+        memFree(started);
+        releaseCSR(csr, tempCSR);
+        return 0;
     }
 
-    result->totalDistance = gScore[destIndex];
+    // Split the city range; a single range runs inline after the SCC pass
+    for (int t = 0; t < numThreads; t++)
+    {
+        workers[t].g = g;
+        workers[t].csr = csr;
+        workers[t].begin = (int)((long long)n * t / numThreads);
+        workers[t].end = (int)((long long)n * (t + 1) / numThreads);
+        if (numThreads > 1)
+            started[t] = pthread_create(&workers[t].thread, NULL, statsWorkerMain,
+                                        &workers[t]) == 0;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    int ok = countComponents(csr, &stats->numComponents, &stats->largestComponent);
 
-    // Trace path
-    int current = destIndex;
-    while (current != -1)
+    for (int t = 0; t < numThreads; t++)
     {
-        addToPath(result, g->cities[current].cityID);
-        current = parent[current];
+        if (started[t])
+            pthread_join(workers[t].thread, NULL);
+        else
+            statsWorkerMain(&workers[t]);
+        mergeStats(stats, &workers[t].part);
+        memFree(workers[t].seen);
     }
-    reversePath(result);
 
-    free(gScore);
-    free(fScore);
-    free(parent);
+    stats->threads = numThreads;
+    stats->elapsedMs = currentTimeMs() - start;
+    memFree(workers);
+    memFree(started);
+    releaseCSR(csr, tempCSR);
 
-    return result;
+    if (!ok)
+        printf("Error: Memory allocation failed!\n");
+    return ok;
+}
+
+/* Print statistics report */
+void displayGraphStats(const GraphStats *stats)
+{
+    printf("\n╔══════════════════════════════════════════════════╗\n");
+    printf("║         GRAPH STATISTICS                         ║\n");
+    printf("╚══════════════════════════════════════════════════╝\n");
+    printf("Cities: %d    Roads: %d\n", stats->numCities, stats->numEdges);
+    printf("Bounding box: (%d, %d) - (%d, %d)\n", stats->minX, stats->minY,
+           stats->maxX, stats->maxY);
+    printf("Road length: min %d, max %d, avg %.1f km\n", stats->minWeight, stats->maxWeight,
+           stats->numEdges ? (double)stats->totalWeight / stats->numEdges : 0.0);
+    printf("Max degree: in %d, out %d\n", stats->maxInDegree, stats->maxOutDegree);
+    printf("Self-loops: %ld    Duplicate roads: %ld\n", stats->selfLoops, stats->duplicates);
+    printf("Strongly connected components: %d (largest %d cities)\n",
+           stats->numComponents, stats->largestComponent);
+
+    printf("\nDegree   In-degree  Out-degree\n");
+    for (int b = 0; b < STATS_DEGREE_BUCKETS; b++)
+    {
+        if (stats->inDegree[b] || stats->outDegree[b])
+            printf("%3d%s  %10ld  %10ld\n", b, b == STATS_DEGREE_BUCKETS - 1 ? "+" : " ",
+                   stats->inDegree[b], stats->outDegree[b]);
+    }
+
+    printf("\nRoad length (km)        Roads\n");
+    for (int b = 0; b < STATS_WEIGHT_BUCKETS; b++)
+    {
+        if (!stats->weights[b])
+            continue;
+        if (b == 0)
+            printf("%10d   %-10s %ld\n", 0, "", stats->weights[b]);
+        else
+            printf("%10lld - %-10lld %ld\n", 1LL << (b - 1), (1LL << b) - 1, stats->weights[b]);
+    }
+    printf("\nComputed in %.2f ms on %d thread%s\n", stats->elapsedMs, stats->threads,
+           stats->threads == 1 ? "" : "s");
+    printf("════════════════════════════════════════════════════\n");
 }
 
 // DISPLAY PATH
@@ -604,13 +2223,14 @@ void displayPath(Graph *g, PathResult *pr)
     printf("\n╔══════════════════════════════════════════════════╗\n");
     printf("║           SHORTEST PATH FOUND                    ║\n");
     printf("╚══════════════════════════════════════════════════╝\n");
-    printf("Total Distance: %d km\n", pr->totalDistance);
+    printf("Total Distance: " DIST_FMT " km\n", pr->totalDistance);
     printf("Number of Cities: %d\n\n", pr->pathLength);
     printf("Path: ");
 
-    for (int i = 0; i < pr->pathLength; i++)
+    const int *path = getPath(pr);
+    for (int i = 0; path && i < pr->pathLength; i++)
     {
-        int index = findCityIndex(g, pr->path[i]);
+        int index = findCityIndex(g, path[i]);
         if (index != -1)
         {
             printf("%s", g->cities[index].cityName);
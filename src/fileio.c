@@ -1,5 +1,9 @@
+#define _POSIX_C_SOURCE 200809L    // pthread_rwlock_t and st_mtim under -std=c11
 #include "fileio.h"
+#include "algorithms.h"
+#include "memtrack.h"
 #include <time.h>
+#include <sys/stat.h>
 
 // TIMESTAMP UTILITY
 
@@ -40,7 +44,7 @@ void logOperation(const char *operation)
 /**
  * Log path query to logs.txt
  */
-void logPathQuery(const char *source, const char *dest, int distance)
+void logPathQuery(const char *source, const char *dest, dist_t distance)
 {
     if (!source || !dest)
         return;
@@ -55,104 +59,1180 @@ void logPathQuery(const char *source, const char *dest, int distance)
     char timestamp[64];
     getCurrentTimestamp(timestamp, sizeof(timestamp));
 
-    fprintf(fp, "%s Shortest path query: %s -> %s (%d km)\n",
+    fprintf(fp, "%s Shortest path query: %s -> %s (" DIST_FMT " km)\n",
             timestamp, source, dest, distance);
     fclose(fp);
 }
 
-//  LOAD GRAPH FROM FILES
+// IMPORT VALIDATION
+static const char *const issueNames[NUM_IMPORT_ISSUES] = {
+    "parse error", "unknown city", "bad distance", "duplicate", "conflicting duplicate"};
 
 /**
- * Load graph from CSV files
+ * Rejected-row counters for the current file, and the reject sample of the load
  */
-int loadGraphFromFiles(Graph *g, const char *citiesFile, const char *roadsFile)
+typedef struct ImportReport
 {
-    if (!g || !citiesFile || !roadsFile)
+    long issues[NUM_IMPORT_ISSUES];
+    long rejected;          // Whole load
+    long sampled;
+    FILE *rejects;          // Opened on the first rejected row
+} ImportReport;
+
+/**
+ * Count a rejected row and copy it to the sample while there is room
+ */
+static void rejectRow(ImportReport *report, ImportIssue issue, const char *file, long lineNo,
+                      const char *line)
+{
+    report->issues[issue]++;
+    report->rejected++;
+    if (report->sampled >= IMPORT_REJECT_SAMPLE)
+        return;
+
+    if (!report->rejects && !(report->rejects = fopen(REJECTS_FILE, "w")))
     {
-        printf("Error: Invalid parameters!\n");
+        report->sampled = IMPORT_REJECT_SAMPLE;
+        return;
+    }
+    fprintf(report->rejects, "%s:%ld: %s: %s\n", file, lineNo, issueNames[issue], line);
+    report->sampled++;
+}
+
+/**
+ * One summary line for the file's rejected rows, then reset the counters
+ */
+static void summariseRejects(ImportReport *report, const char *file)
+{
+    long total = 0;
+    for (int i = 0; i < NUM_IMPORT_ISSUES; i++)
+        total += report->issues[i];
+    if (total == 0)
+        return;
+
+    char message[256];
+    const char *separator = " (";
+    int len = snprintf(message, sizeof(message), "Rejected %ld rows from %s", total, file);
+    for (int i = 0; i < NUM_IMPORT_ISSUES && len < (int)sizeof(message); i++)
+    {
+        if (!report->issues[i])
+            continue;
+        len += snprintf(message + len, sizeof(message) - len, "%s%s: %ld", separator,
+                        issueNames[i], report->issues[i]);
+        separator = ", ";
+    }
+    if (len < (int)sizeof(message))
+        snprintf(message + len, sizeof(message) - len, ")");
+    printf("⚠️  %s, sample in %s\n", message, REJECTS_FILE);
+    logOperation(message);
+    memset(report->issues, 0, sizeof(report->issues));
+}
+
+/**
+ * Read one row without its line ending; an over-long row is consumed whole
+ * and returns -1. Returns 0 at end of file
+ */
+static int readRow(FILE *fp, char *line, int size)
+{
+    if (!fgets(line, size, fp))
         return 0;
+
+    size_t len = strcspn(line, "\r\n");
+    if (line[len] == '\0' && !feof(fp))
+    {
+        int c;
+        while ((c = fgetc(fp)) != EOF && c != '\n')
+            ;
+        return -1;
     }
+    line[len] = 0;
+    return 1;
+}
 
-    FILE *fp;
-    char line[256];
+/**
+ * Nothing but blanks
+ */
+static int blankRow(const char *line)
+{
+    return line[strspn(line, " \t")] == '\0';
+}
 
-    // LOAD CITIES
-    fp = fopen(citiesFile, "r");
+/**
+ * Open a map file and skip its header line; NULL (reported) on failure
+ */
+static FILE *openMapFile(const char *file, const char *what)
+{
+    char line[256];
+    FILE *fp = fopen(file, "r");
     if (!fp)
     {
-        printf("Error: Could not open %s\n", citiesFile);
-        return 0;
+        printf("Error: Could not open %s\n", file);
+        return NULL;
     }
 
-    // Skip header line
-    if (!fgets(line, sizeof(line), fp))
+    if (readRow(fp, line, sizeof(line)) == 0)
     {
-        printf("Error: Empty cities file!\n");
+        printf("Error: Empty %s file!\n", what);
         fclose(fp);
-        return 0;
+        return NULL;
     }
+    return fp;
+}
+
+/**
+ * Parse CSV: CityID,CityName,X_Coord,Y_Coord
+ */
+static int parseCityRow(const char *line, int *cityID, char *cityName, int *x, int *y)
+{
+    int used = 0;
+    return sscanf(line, "%d,%49[^,],%d,%d %n", cityID, cityName, x, y, &used) == 4 &&
+           line[used] == '\0';
+}
+
+/**
+ * Parse CSV: FromCityID,ToCityID,Distance
+ */
+static int parseRoadRow(const char *line, int *fromID, int *toID, int *distance)
+{
+    int used = 0;
+    return sscanf(line, "%d,%d,%d %n", fromID, toID, distance, &used) == 3 && line[used] == '\0';
+}
+
+//  LOAD GRAPH FROM FILES
+
+/**
+ * Background loader state
+ * progress is guarded by mutex; changed is signalled on every update
+ */
+struct GraphLoader
+{
+    Graph *g;
+    char *citiesFile;
+    char *roadsFile;
+    pthread_rwlock_t *graphLock;
+    LoadProgressCallback callback;
+    void *userData;
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t changed;
+    LoadProgress progress;
+    ImportReport report;    // Loader thread only; totals copied into progress
+    double startMs;
+    volatile int stopRequested;
+};
+
+/**
+ * Publish progress to waiters and the callback (loader may be NULL)
+ */
+static void reportProgress(GraphLoader *loader, LoadStage stage, long cities, long roads)
+{
+    if (!loader)
+        return;
+
+    LoadProgress snapshot;
+    pthread_mutex_lock(&loader->mutex);
+    loader->progress.stage = stage;
+    loader->progress.citiesLoaded = cities;
+    loader->progress.roadsLoaded = roads;
+    loader->progress.rowsRejected = loader->report.rejected;
+    loader->progress.elapsedMs = currentTimeMs() - loader->startMs;
+    snapshot = loader->progress;
+    pthread_cond_broadcast(&loader->changed);
+    pthread_mutex_unlock(&loader->mutex);
+
+    if (loader->callback)
+        loader->callback(&snapshot, loader->userData);
+}
+
+/**
+ * Read cities file; returns cities added, or -1 if unreadable or stopped
+ */
+static long loadCities(Graph *g, const char *citiesFile, GraphLoader *loader,
+                       ImportReport *report)
+{
+    char line[256];
+    FILE *fp = openMapFile(citiesFile, "cities");
+    if (!fp)
+        return -1;
 
     int cityID, x, y;
     char cityName[MAX_CITY_NAME];
-    int citiesLoaded = 0;
+    long citiesLoaded = 0, lines = 1;
+    int status;
 
-    while (fgets(line, sizeof(line), fp))
+    while ((status = readRow(fp, line, sizeof(line))) != 0)
     {
-        // Remove trailing newline
-        line[strcspn(line, "\r\n")] = 0;
+        lines++;
 
-        // Parse CSV: CityID,CityName,X_Coord,Y_Coord
-        if (sscanf(line, "%d,%[^,],%d,%d", &cityID, cityName, &x, &y) == 4)
+        if (status < 0 || !parseCityRow(line, &cityID, cityName, &x, &y))
+        {
+            if (status < 0 || !blankRow(line))
+                rejectRow(report, ISSUE_PARSE, citiesFile, lines, status < 0 ? "(row too long)" : line);
+        }
+        else
         {
-            if (addCity(g, cityID, cityName, x, y))
+            int index = findCityIndex(g, cityID);
+            if (index != -1)
+            {
+                City *c = &g->cities[index];
+                int same = strcmp(c->cityName, cityName) == 0 && c->x == x && c->y == y;
+                rejectRow(report, same ? ISSUE_DUPLICATE : ISSUE_CONFLICT, citiesFile, lines, line);
+            }
+            else if (addCity(g, cityID, cityName, x, y))
             {
                 citiesLoaded++;
             }
         }
+
+        if (loader && lines % LOAD_PROGRESS_INTERVAL == 0)
+        {
+            if (loader->stopRequested)
+            {
+                fclose(fp);
+                return -1;
+            }
+            reportProgress(loader, LOAD_CITIES, citiesLoaded, 0);
+        }
     }
     fclose(fp);
-    printf("✓ Loaded %d cities from %s\n", citiesLoaded, citiesFile);
+    printf("✓ Loaded %ld cities from %s\n", citiesLoaded, citiesFile);
+    summariseRejects(report, citiesFile);
+    return citiesLoaded;
+}
 
-    // LOAD ROADS
-    fp = fopen(roadsFile, "r");
+/**
+ * Read roads file; returns roads added, or -1 if unreadable or stopped
+ */
+static long loadRoads(Graph *g, const char *roadsFile, GraphLoader *loader, long citiesLoaded,
+                      ImportReport *report)
+{
+    char line[256];
+    FILE *fp = openMapFile(roadsFile, "roads");
     if (!fp)
+        return -1;
+
+    int fromID, toID, distance;
+    long roadsLoaded = 0, lines = 1;
+    int status;
+
+    while ((status = readRow(fp, line, sizeof(line))) != 0)
+    {
+        lines++;
+
+        if (status < 0 || !parseRoadRow(line, &fromID, &toID, &distance))
+        {
+            if (status < 0 || !blankRow(line))
+                rejectRow(report, ISSUE_PARSE, roadsFile, lines, status < 0 ? "(row too long)" : line);
+        }
+        else if (findCityIndex(g, fromID) == -1 || findCityIndex(g, toID) == -1)
+        {
+            rejectRow(report, ISSUE_UNKNOWN_CITY, roadsFile, lines, line);
+        }
+        else if (distance <= 0 || distance > ROAD_MAX_DISTANCE)
+        {
+            rejectRow(report, ISSUE_BAD_DISTANCE, roadsFile, lines, line);
+        }
+        else
+        {
+            int existing = getRoadDistance(g, fromID, toID);
+            if (existing != -1)
+                rejectRow(report, existing == distance ? ISSUE_DUPLICATE : ISSUE_CONFLICT,
+                          roadsFile, lines, line);
+            else if (addRoad(g, fromID, toID, distance))
+                roadsLoaded++;
+        }
+
+        if (loader && lines % LOAD_PROGRESS_INTERVAL == 0)
+        {
+            if (loader->stopRequested)
+            {
+                fclose(fp);
+                return -1;
+            }
+            reportProgress(loader, LOAD_ROADS, citiesLoaded, roadsLoaded);
+        }
+    }
+    fclose(fp);
+    printf("✓ Loaded %ld roads from %s\n", roadsLoaded, roadsFile);
+    summariseRejects(report, roadsFile);
+    return roadsLoaded;
+}
+
+/**
+ * Post-import sanity gate: summarise the graph, warn about suspicious data
+ */
+static void checkLoadedGraph(Graph *g)
+{
+    GraphStats stats;
+    if (!graphStats(g, &stats, 0))
+        return;
+
+    printf("✓ Graph check: %d roads, %d strongly connected components (largest %d) in %.1f ms\n",
+           stats.numEdges, stats.numComponents, stats.largestComponent, stats.elapsedMs);
+    if (stats.selfLoops == 0 && stats.duplicates == 0)
+        return;
+
+    char message[128];
+    snprintf(message, sizeof(message), "Graph check: %ld self-loop roads, %ld duplicate roads",
+             stats.selfLoops, stats.duplicates);
+    printf("⚠️  %s\n", message);
+    logOperation(message);
+}
+
+/**
+ * Load graph from CSV files
+ */
+int loadGraphFromFiles(Graph *g, const char *citiesFile, const char *roadsFile)
+{
+    if (!g || !citiesFile || !roadsFile)
     {
-        printf("Error: Could not open %s\n", roadsFile);
+        printf("Error: Invalid parameters!\n");
+        return 0;
+    }
+
+    int wasQuiet = g->quiet;
+    g->quiet = 1;
+    ImportReport report;
+    memset(&report, 0, sizeof(report));
+    long cities = loadCities(g, citiesFile, NULL, &report);
+    long roads = cities < 0 ? -1 : loadRoads(g, roadsFile, NULL, cities, &report);
+    if (report.rejects)
+        fclose(report.rejects);
+    g->quiet = wasQuiet;
+
+    if (roads < 0)
         return 0;
+
+    logOperation("Graph loaded from files successfully");
+    prepareGraph(g);
+    checkLoadedGraph(g);
+    return 1;
+}
+
+// INCREMENTAL RELOAD
+
+/**
+ * Changes collected by a reload, applied as one batch
+ */
+typedef struct MutationList
+{
+    GraphMutation *ops;
+    int count;
+    int capacity;
+} MutationList;
+
+/**
+ * Append a zeroed change; NULL if out of memory
+ */
+static GraphMutation *pushMutation(MutationList *list, GraphMutationType type)
+{
+    if (list->count == list->capacity)
+    {
+        int capacity = list->capacity ? 2 * list->capacity : 256;
+        GraphMutation *ops = (GraphMutation *)memRealloc(MEM_RELOAD, list->ops,
+                                                         capacity * sizeof(GraphMutation));
+        if (!ops)
+        {
+            printf("Error: Memory allocation failed for reload!\n");
+            return NULL;
+        }
+        list->ops = ops;
+        list->capacity = capacity;
+    }
+    GraphMutation *op = &list->ops[list->count++];
+    memset(op, 0, sizeof(*op));
+    op->type = type;
+    return op;
+}
+
+/**
+ * City ID or road key -> index of its pending change, open addressing
+ */
+typedef struct PendingIndex
+{
+    long long *keys;
+    int *values;            // -1 = empty slot
+    int mask;
+    int count;
+} PendingIndex;
+
+static long long roadKey(int fromID, int toID)
+{
+    return ((long long)fromID << 32) | (unsigned int)toID;
+}
+
+/**
+ * Slot holding key, or the empty slot where it belongs
+ */
+static int pendingSlot(const PendingIndex *index, long long key)
+{
+    unsigned long long h = (unsigned long long)key * 0x9E3779B97F4A7C15ull;
+    int i = (int)(h >> 32) & index->mask;
+    while (index->values[i] != -1 && index->keys[i] != key)
+        i = (i + 1) & index->mask;
+    return i;
+}
+
+/**
+ * Pending change for key, or -1
+ */
+static int pendingFind(const PendingIndex *index, long long key)
+{
+    return index->values ? index->values[pendingSlot(index, key)] : -1;
+}
+
+/**
+ * Record key -> change, doubling the table at half full; 0 if out of memory
+ */
+static int pendingAdd(PendingIndex *index, long long key, int value)
+{
+    if (2 * (index->count + 1) > index->mask + 1)
+    {
+        int size = index->values ? 2 * (index->mask + 1) : 1024;
+        PendingIndex grown = {(long long *)memAlloc(MEM_RELOAD, size * sizeof(long long)),
+                              (int *)memAlloc(MEM_RELOAD, size * sizeof(int)), size - 1, index->count};
+        if (!grown.keys || !grown.values)
+        {
+            memFree(grown.keys);
+            memFree(grown.values);
+            printf("Error: Memory allocation failed for reload!\n");
+            return 0;
+        }
+        for (int i = 0; i < size; i++)
+            grown.values[i] = -1;
+        for (int i = 0; index->values && i <= index->mask; i++)
+        {
+            if (index->values[i] == -1)
+                continue;
+            int slot = pendingSlot(&grown, index->keys[i]);
+            grown.keys[slot] = index->keys[i];
+            grown.values[slot] = index->values[i];
+        }
+        memFree(index->keys);
+        memFree(index->values);
+        *index = grown;
+    }
+
+    int slot = pendingSlot(index, key);
+    if (index->values[slot] == -1)
+        index->count++;
+    index->keys[slot] = key;
+    index->values[slot] = value;
+    return 1;
+}
+
+/**
+ * Diff state: what the files say, relative to the graph
+ */
+typedef struct ReloadDiff
+{
+    Graph *g;
+    char *seen;                 // Per city index: row still present; NULL if cities not read
+    PendingIndex pendingCities; // City ID -> change
+    PendingIndex pendingRoads;  // Road key -> change
+    MutationList changes;
+    ImportReport report;
+    long unknownCityRoads;      // From the roads pass
+    ReloadSummary *summary;
+} ReloadDiff;
+
+/**
+ * Queue a change and index it by key; NULL if out of memory
+ */
+static GraphMutation *queueChange(ReloadDiff *d, PendingIndex *index, long long key,
+                                  GraphMutationType type)
+{
+    GraphMutation *op = pushMutation(&d->changes, type);
+    if (op && !pendingAdd(index, key, d->changes.count - 1))
+        op = NULL;
+    return op;
+}
+
+/**
+ * City present once the changes are applied
+ */
+static int cityWillExist(ReloadDiff *d, int cityID)
+{
+    int index = findCityIndex(d->g, cityID);
+    if (index != -1)
+        return !d->seen || d->seen[index];
+    return pendingFind(&d->pendingCities, cityID) != -1;
+}
+
+/**
+ * Edge carrying fromID -> toID: in the source's list, or a two-way edge
+ * stored at the destination (*back set); NULL if there is none
+ */
+static Edge *storedRoad(Graph *g, int fromID, int toID, int *back)
+{
+    int fromIndex = findCityIndex(g, fromID);
+    int toIndex = findCityIndex(g, toID);
+    *back = 0;
+    for (Edge *e = fromIndex != -1 ? g->cities[fromIndex].adjList : NULL; e; e = e->next)
+    {
+        if (e->destCityID == toID)
+            return e;
+    }
+    for (Edge *e = toIndex != -1 ? g->cities[toIndex].adjList : NULL; e; e = e->next)
+    {
+        if (e->destCityID == fromID && (e->flags & ROAD_TWO_WAY))
+        {
+            *back = 1;
+            return e;
+        }
     }
+    return NULL;
+}
 
-    // Skip header line
-    if (!fgets(line, sizeof(line), fp))
+/**
+ * Compare the cities file with the graph; 0 if unreadable or out of memory
+ */
+static int diffCities(ReloadDiff *d, const char *citiesFile)
+{
+    Graph *g = d->g;
+    FILE *fp = openMapFile(citiesFile, "cities");
+    if (!fp)
+        return 0;
+    d->seen = (char *)memCalloc(MEM_RELOAD, g->numCities > 0 ? g->numCities : 1, 1);
+    if (!d->seen)
     {
-        printf("Error: Empty roads file!\n");
+        printf("Error: Memory allocation failed for reload!\n");
         fclose(fp);
         return 0;
     }
 
-    int fromID, toID, distance;
-    int roadsLoaded = 0;
+    char line[256];
+    char cityName[MAX_CITY_NAME];
+    int cityID, x, y, status, ok = 1;
+    long lines = 1;
+    ReloadSummary *summary = d->summary;
+
+    while (ok && (status = readRow(fp, line, sizeof(line))) != 0)
+    {
+        lines++;
+        if (status < 0 || !parseCityRow(line, &cityID, cityName, &x, &y))
+        {
+            if (status < 0 || !blankRow(line))
+                rejectRow(&d->report, ISSUE_PARSE, citiesFile, lines, status < 0 ? "(row too long)" : line);
+            continue;
+        }
+
+        int pending = pendingFind(&d->pendingCities, cityID);
+        int index = findCityIndex(g, cityID);
+        if (pending != -1 || (index != -1 && d->seen[index]))
+        {
+            // Repeated ID: the first row wins, as in a full load
+            const GraphMutation *op = pending != -1 ? &d->changes.ops[pending] : NULL;
+            const City *c = op ? NULL : &g->cities[index];
+            int same = op ? strcmp(op->cityName, cityName) == 0 && op->x == x && op->y == y
+                          : strcmp(c->cityName, cityName) == 0 && c->x == x && c->y == y;
+            rejectRow(&d->report, same ? ISSUE_DUPLICATE : ISSUE_CONFLICT, citiesFile, lines, line);
+            continue;
+        }
+
+        GraphMutation *op = NULL;
+        if (index == -1)
+        {
+            op = queueChange(d, &d->pendingCities, cityID, MUTATE_ADD_CITY);
+            summary->citiesAdded++;
+        }
+        else
+        {
+            const City *c = &g->cities[index];
+            d->seen[index] = 1;
+            if (strcmp(c->cityName, cityName) == 0 && c->x == x && c->y == y)
+                continue;
+            op = queueChange(d, &d->pendingCities, cityID, MUTATE_UPDATE_CITY);
+            summary->citiesChanged++;
+        }
+        if (!op)
+        {
+            ok = 0;
+            break;
+        }
+        op->cityID = cityID;
+        strcpy(op->cityName, cityName);
+        op->x = x;
+        op->y = y;
+    }
+    fclose(fp);
+    summariseRejects(&d->report, citiesFile);
+
+    // Cities whose rows are gone
+    for (int i = 0; ok && i < g->numCities; i++)
+    {
+        if (d->seen[i])
+            continue;
+        GraphMutation *op = pushMutation(&d->changes, MUTATE_REMOVE_CITY);
+        if (!op)
+            ok = 0;
+        else
+        {
+            op->cityID = g->cities[i].cityID;
+            summary->citiesRemoved++;
+        }
+    }
+    return ok;
+}
+
+/**
+ * Compare the roads file with the graph, marking the roads it still has;
+ * 0 if unreadable or out of memory
+ */
+static int diffRoads(ReloadDiff *d, const char *roadsFile)
+{
+    Graph *g = d->g;
+    FILE *fp = openMapFile(roadsFile, "roads");
+    if (!fp)
+        return 0;
+
+    char line[256];
+    int fromID, toID, distance, status, ok = 1;
+    long lines = 1;
+    ReloadSummary *summary = d->summary;
+
+    while (ok && (status = readRow(fp, line, sizeof(line))) != 0)
+    {
+        lines++;
+        if (status < 0 || !parseRoadRow(line, &fromID, &toID, &distance))
+        {
+            if (status < 0 || !blankRow(line))
+                rejectRow(&d->report, ISSUE_PARSE, roadsFile, lines, status < 0 ? "(row too long)" : line);
+            continue;
+        }
+        if (!cityWillExist(d, fromID) || !cityWillExist(d, toID))
+        {
+            rejectRow(&d->report, ISSUE_UNKNOWN_CITY, roadsFile, lines, line);
+            continue;
+        }
+        if (distance <= 0 || distance > ROAD_MAX_DISTANCE)
+        {
+            rejectRow(&d->report, ISSUE_BAD_DISTANCE, roadsFile, lines, line);
+            continue;
+        }
+
+        int back = 0;
+        int pending = pendingFind(&d->pendingRoads, roadKey(fromID, toID));
+        Edge *e = pending == -1 ? storedRoad(g, fromID, toID, &back) : NULL;
+        unsigned char mark = back ? ROAD_SEEN_BACK : ROAD_SEEN;
+        if (pending != -1 || (e && (e->flags & mark)))
+        {
+            // Repeated road: the first row wins, as in a full load
+            int kept = pending != -1 ? d->changes.ops[pending].distance : e->distance;
+            rejectRow(&d->report, kept == distance ? ISSUE_DUPLICATE : ISSUE_CONFLICT, roadsFile,
+                      lines, line);
+            continue;
+        }
+
+        if (e)
+        {
+            e->flags |= mark;
+            if (e->distance == distance)
+                continue;
+            summary->roadsChanged++;
+        }
+        else
+        {
+            summary->roadsAdded++;
+        }
+        GraphMutation *op = queueChange(d, &d->pendingRoads, roadKey(fromID, toID), MUTATE_SET_ROAD);
+        if (!op)
+        {
+            ok = 0;
+            break;
+        }
+        op->cityID = fromID;
+        op->toCityID = toID;
+        op->distance = distance;
+    }
+    fclose(fp);
+    d->unknownCityRoads = d->report.issues[ISSUE_UNKNOWN_CITY];
+    summariseRejects(&d->report, roadsFile);
+
+    // Unmarked directions are gone; roads of removed cities go with them.
+    // Every mark is cleared, even after a failure
+    for (int i = 0; i < g->numCities; i++)
+    {
+        int fromKept = !d->seen || d->seen[i];
+        for (Edge *e = g->cities[i].adjList; e; e = e->next)
+        {
+            int toIndex = findCityIndex(g, e->destCityID);
+            int toKept = toIndex != -1 && (!d->seen || d->seen[toIndex]);
+            for (int dir = 0; ok && fromKept && toKept && dir < 2; dir++)
+            {
+                if (dir == 0 ? (e->flags & ROAD_SEEN)
+                             : !(e->flags & ROAD_TWO_WAY) || (e->flags & ROAD_SEEN_BACK))
+                    continue;
+                GraphMutation *op = pushMutation(&d->changes, MUTATE_REMOVE_ROAD);
+                if (!op)
+                {
+                    ok = 0;
+                    break;
+                }
+                op->cityID = dir == 0 ? g->cities[i].cityID : e->destCityID;
+                op->toCityID = dir == 0 ? e->destCityID : g->cities[i].cityID;
+                summary->roadsRemoved++;
+            }
+            e->flags &= ~(ROAD_SEEN | ROAD_SEEN_BACK);
+        }
+    }
+    return ok;
+}
+
+/**
+ * Modification time of a stat result in nanoseconds
+ * Windows and macOS name the field differently; the Windows CRT has whole
+ * seconds only, which the takenAt check below already allows for
+ */
+static long long modifiedNs(const struct stat *st)
+{
+#if defined(_WIN32)
+    return (long long)st->st_mtime * 1000000000LL;
+#elif defined(__APPLE__)
+    return (long long)st->st_mtimespec.tv_sec * 1000000000LL + st->st_mtimespec.tv_nsec;
+#else
+    return (long long)st->st_mtim.tv_sec * 1000000000LL + st->st_mtim.tv_nsec;
+#endif
+}
+
+/**
+ * Stat and block-hash a file into next; returns 1 if it may differ from
+ * old, 0 if not, -1 if unreadable
+ */
+static int fingerprintFile(const char *file, const FileFingerprint *old, FileFingerprint *next,
+                           int *blocksChanged)
+{
+    next->numBlocks = 0;
+    next->blockHashes = NULL;   // Callers free it on every path, failures included
+
+    struct stat st;
+    if (stat(file, &st) != 0)
+    {
+        printf("Error: Could not open %s\n", file);
+        return -1;
+    }
+    next->size = (long long)st.st_size;
+    next->mtimeNs = modifiedNs(&st);
+    next->takenAt = (long long)time(NULL);
+
+    // Same size and mtime: trust it unless written in the second the old
+    // fingerprint was taken, when a later write could share the mtime
+    if (old->size == next->size && old->mtimeNs == next->mtimeNs &&
+        next->mtimeNs / 1000000000LL < old->takenAt)
+    {
+        next->takenAt = old->takenAt;
+        next->blockHashes = (unsigned long long *)memAlloc(MEM_RELOAD,
+            (old->numBlocks > 0 ? old->numBlocks : 1) * sizeof(unsigned long long));
+        if (next->blockHashes)
+        {
+            memcpy(next->blockHashes, old->blockHashes, old->numBlocks * sizeof(unsigned long long));
+            next->numBlocks = old->numBlocks;
+            return 0;
+        }
+        // Out of memory: fall through and rehash into a fresh array
+    }
 
-    while (fgets(line, sizeof(line), fp))
+    FILE *fp = fopen(file, "rb");
+    int capacity = (int)(next->size / FINGERPRINT_BLOCK_SIZE) + 1;
+    next->blockHashes = (unsigned long long *)memAlloc(MEM_RELOAD,
+                                                       capacity * sizeof(unsigned long long));
+    if (!fp || !next->blockHashes)
     {
-        // Remove trailing newline
-        line[strcspn(line, "\r\n")] = 0;
+        printf("Error: Could not fingerprint %s\n", file);
+        if (fp)
+            fclose(fp);
+        memFree(next->blockHashes);
+        next->blockHashes = NULL;
+        return -1;
+    }
 
-        // Parse CSV: FromCityID,ToCityID,Distance
-        if (sscanf(line, "%d,%d,%d", &fromID, &toID, &distance) == 3)
+    unsigned char buffer[65536];
+    unsigned long long h = 14695981039346656037ull;
+    long filled = 0;
+    size_t got;
+    while ((got = fread(buffer, 1, sizeof(buffer), fp)) > 0)
+    {
+        for (size_t i = 0; i < got; i++)
         {
-            if (addRoad(g, fromID, toID, distance))
+            h = (h ^ buffer[i]) * 1099511628211ull;
+            if (++filled < FINGERPRINT_BLOCK_SIZE)
+                continue;
+            if (next->numBlocks == capacity)
             {
-                roadsLoaded++;
+                // Grew since the stat
+                unsigned long long *grown = (unsigned long long *)memRealloc(MEM_RELOAD,
+                    next->blockHashes, 2 * capacity * sizeof(unsigned long long));
+                if (!grown)
+                    break;
+                next->blockHashes = grown;
+                capacity *= 2;
             }
+            next->blockHashes[next->numBlocks++] = h;
+            h = 14695981039346656037ull;
+            filled = 0;
         }
     }
+    if (filled > 0 && next->numBlocks < capacity)
+        next->blockHashes[next->numBlocks++] = h;
     fclose(fp);
-    printf("✓ Loaded %d roads from %s\n", roadsLoaded, roadsFile);
 
-    logOperation("Graph loaded from files successfully");
+    int changed = 0;
+    for (int i = 0; i < next->numBlocks || i < old->numBlocks; i++)
+    {
+        if (i >= next->numBlocks || i >= old->numBlocks ||
+            next->blockHashes[i] != old->blockHashes[i])
+            changed++;
+    }
+    *blocksChanged += changed;
+    return changed > 0 || old->size != next->size;
+}
+
+/**
+ * Empty fingerprint
+ */
+void initMapFingerprint(MapFingerprint *fp)
+{
+    if (!fp)
+        return;
+    memset(fp, 0, sizeof(*fp));
+    fp->cities.size = -1;
+    fp->roads.size = -1;
+    fp->unknownCityRoads = -1;
+}
+
+/**
+ * Free block hashes
+ */
+void freeMapFingerprint(MapFingerprint *fp)
+{
+    if (!fp)
+        return;
+    memFree(fp->cities.blockHashes);
+    memFree(fp->roads.blockHashes);
+    initMapFingerprint(fp);
+}
+
+/**
+ * Fresh fingerprint of both files
+ */
+int takeMapFingerprint(MapFingerprint *fp, const char *citiesFile, const char *roadsFile)
+{
+    if (!fp || !citiesFile || !roadsFile)
+    {
+        printf("Error: Invalid parameters!\n");
+        return 0;
+    }
+
+    MapFingerprint none, next;
+    initMapFingerprint(&none);
+    initMapFingerprint(&next);
+    int blocks = 0;
+    if (fingerprintFile(citiesFile, &none.cities, &next.cities, &blocks) < 0 ||
+        fingerprintFile(roadsFile, &none.roads, &next.roads, &blocks) < 0)
+    {
+        freeMapFingerprint(&next);
+        return 0;
+    }
+
+    // Rejected rows of the load are not counted, so new cities rediff roads
+    freeMapFingerprint(fp);
+    *fp = next;
+    return 1;
+}
+
+/**
+ * Diff-based reload
+ */
+int reloadGraphFromFiles(Graph *g, const char *citiesFile, const char *roadsFile,
+                         MapFingerprint *fp, ReloadSummary *summary)
+{
+    if (!g || !citiesFile || !roadsFile || !fp)
+    {
+        printf("Error: Invalid parameters!\n");
+        return 0;
+    }
+
+    double startMs = currentTimeMs();
+    ReloadSummary local;
+    if (!summary)
+        summary = &local;
+    memset(summary, 0, sizeof(*summary));
+
+    FileFingerprint cities, roads;
+    memset(&cities, 0, sizeof(cities));
+    memset(&roads, 0, sizeof(roads));
+    int citiesChanged = fingerprintFile(citiesFile, &fp->cities, &cities, &summary->blocksChanged);
+    int roadsChanged = citiesChanged < 0 ? -1
+                                         : fingerprintFile(roadsFile, &fp->roads, &roads,
+                                                           &summary->blocksChanged);
+
+    ReloadDiff d;
+    memset(&d, 0, sizeof(d));
+    d.g = g;
+    d.summary = summary;
+    int ok = citiesChanged >= 0 && roadsChanged >= 0;
+    int roadsRead = 0;
+    if (ok && citiesChanged)
+    {
+        summary->filesRead++;
+        ok = diffCities(&d, citiesFile);
+    }
+    // New cities can make rows valid that were rejected for a missing endpoint
+    if (ok && (roadsChanged || (summary->citiesAdded > 0 && fp->unknownCityRoads != 0)))
+    {
+        summary->filesRead++;
+        roadsRead = 1;
+        ok = diffRoads(&d, roadsFile);
+    }
+    if (d.report.rejects)
+        fclose(d.report.rejects);
+    summary->rowsRejected = d.report.rejected;
+
+    if (ok)
+    {
+        if (d.changes.count > 0)
+        {
+            applyGraphMutations(g, d.changes.ops, d.changes.count);
+            prepareGraph(g);
+        }
+        if (roadsRead)
+            fp->unknownCityRoads = d.unknownCityRoads;
+        else if (summary->citiesRemoved > 0)
+            fp->unknownCityRoads = -1;  // Rows naming the removed cities are now invalid
+        memFree(fp->cities.blockHashes);
+        memFree(fp->roads.blockHashes);
+        fp->cities = cities;
+        fp->roads = roads;
+    }
+    else
+    {
+        memFree(cities.blockHashes);
+        memFree(roads.blockHashes);
+    }
+    memFree(d.seen);
+    memFree(d.changes.ops);
+    memFree(d.pendingCities.keys);
+    memFree(d.pendingCities.values);
+    memFree(d.pendingRoads.keys);
+    memFree(d.pendingRoads.values);
+    summary->elapsedMs = currentTimeMs() - startMs;
+    if (!ok)
+        return 0;
+
+    if (summary->filesRead == 0)
+    {
+        printf("✓ Map files unchanged, nothing to reload\n");
+        return 1;
+    }
+    char message[256];
+    snprintf(message, sizeof(message),
+             "Graph reloaded from files: cities +%ld -%ld ~%ld, roads +%ld -%ld ~%ld "
+             "(files read: %d, blocks changed: %d)",
+             summary->citiesAdded, summary->citiesRemoved, summary->citiesChanged,
+             summary->roadsAdded, summary->roadsRemoved, summary->roadsChanged,
+             summary->filesRead, summary->blocksChanged);
+    printf("✓ %s in %.1f ms\n", message, summary->elapsedMs);
+    logOperation(message);
     return 1;
 }
 
+// BACKGROUND LOADING
+
+/**
+ * Loader thread - base graph under the write lock, CSR under the read lock
+ */
+static void *loaderMain(void *arg)
+{
+    GraphLoader *loader = (GraphLoader *)arg;
+    Graph *g = loader->g;
+
+    // Stage 1-2: cities and roads. No change events for bulk-loaded data.
+    if (loader->graphLock)
+        pthread_rwlock_wrlock(loader->graphLock);
+    GraphEventListener listener = g->listener;
+    int wasQuiet = g->quiet;
+    g->listener = NULL;
+    g->quiet = 1;
+
+    reportProgress(loader, LOAD_CITIES, 0, 0);
+    long cities = loadCities(g, loader->citiesFile, loader, &loader->report);
+    long roads = -1;
+    if (cities >= 0)
+    {
+        reportProgress(loader, LOAD_ROADS, cities, 0);
+        roads = loadRoads(g, loader->roadsFile, loader, cities, &loader->report);
+    }
+    if (loader->report.rejects)
+        fclose(loader->report.rejects);
+    loader->report.rejects = NULL;
+
+    g->listener = listener;
+    g->quiet = wasQuiet;
+    unsigned long version = g->version;
+    if (loader->graphLock)
+        pthread_rwlock_unlock(loader->graphLock);
+
+    if (roads < 0)
+    {
+        reportProgress(loader, LOAD_FAILED, cities > 0 ? cities : 0, 0);
+        return NULL;
+    }
+    logOperation("Graph loaded from files successfully");
+
+    // Stage 3: accelerated structures, concurrent with queries
+    reportProgress(loader, LOAD_INDICES, cities, roads);
+    if (loader->graphLock)
+        pthread_rwlock_rdlock(loader->graphLock);
+    CSRGraph *csr = loader->stopRequested ? NULL : buildCSR(g);
+    if (loader->graphLock)
+        pthread_rwlock_unlock(loader->graphLock);
+
+    // Attach only if nothing changed while building
+    if (loader->graphLock)
+        pthread_rwlock_wrlock(loader->graphLock);
+    if (csr && g->version == version && !g->csr)
+    {
+        g->csr = csr;
+        csr = NULL;
+        // Keep only the forward rows if the snapshot broke the budget
+        if (trimGraphCaches(g, 0) > 0)
+            noteMemoryRefusal("transposed CSR index");
+    }
+    if (loader->graphLock)
+        pthread_rwlock_unlock(loader->graphLock);
+    freeCSR(csr);
+
+    // Sanity gate, concurrent with queries
+    if (loader->graphLock)
+        pthread_rwlock_rdlock(loader->graphLock);
+    if (!loader->stopRequested)
+        checkLoadedGraph(g);
+    if (loader->graphLock)
+        pthread_rwlock_unlock(loader->graphLock);
+
+    reportProgress(loader, loader->stopRequested ? LOAD_FAILED : LOAD_READY, cities, roads);
+    return NULL;
+}
+
+static char *copyString(const char *src)
+{
+    char *dst = (char *)malloc(strlen(src) + 1);
+    if (dst)
+        strcpy(dst, src);
+    return dst;
+}
+
+/**
+ * Start background load
+ */
+GraphLoader *startGraphLoad(Graph *g, const char *citiesFile, const char *roadsFile,
+                            pthread_rwlock_t *graphLock, LoadProgressCallback callback,
+                            void *userData)
+{
+    if (!g || !citiesFile || !roadsFile)
+    {
+        printf("Error: Invalid parameters!\n");
+        return NULL;
+    }
+
+    GraphLoader *loader = (GraphLoader *)calloc(1, sizeof(GraphLoader));
+    if (!loader)
+    {
+        printf("Error: Memory allocation failed for loader!\n");
+        return NULL;
+    }
+    loader->g = g;
+    loader->citiesFile = copyString(citiesFile);
+    loader->roadsFile = copyString(roadsFile);
+    loader->graphLock = graphLock;
+    loader->callback = callback;
+    loader->userData = userData;
+    loader->progress.stage = LOAD_CITIES;
+    loader->startMs = currentTimeMs();
+    pthread_mutex_init(&loader->mutex, NULL);
+    pthread_cond_init(&loader->changed, NULL);
+
+    if (!loader->citiesFile || !loader->roadsFile ||
+        pthread_create(&loader->thread, NULL, loaderMain, loader) != 0)
+    {
+        printf("Error: Could not start background loader!\n");
+        pthread_cond_destroy(&loader->changed);
+        pthread_mutex_destroy(&loader->mutex);
+        free(loader->citiesFile);
+        free(loader->roadsFile);
+        free(loader);
+        return NULL;
+    }
+    return loader;
+}
+
+/**
+ * Snapshot of progress
+ */
+LoadStage getLoadProgress(GraphLoader *loader, LoadProgress *progress)
+{
+    pthread_mutex_lock(&loader->mutex);
+    LoadProgress snapshot = loader->progress;
+    pthread_mutex_unlock(&loader->mutex);
+
+    if (progress)
+        *progress = snapshot;
+    return snapshot.stage;
+}
+
+/**
+ * Wait for a stage
+ */
+int waitGraphLoad(GraphLoader *loader, LoadStage stage)
+{
+    pthread_mutex_lock(&loader->mutex);
+    while (loader->progress.stage < stage)
+        pthread_cond_wait(&loader->changed, &loader->mutex);
+    int reached = loader->progress.stage != LOAD_FAILED || stage == LOAD_FAILED;
+    pthread_mutex_unlock(&loader->mutex);
+    return reached;
+}
+
+/**
+ * Stop, join and free
+ */
+int finishGraphLoad(GraphLoader *loader)
+{
+    if (!loader)
+        return 0;
+
+    loader->stopRequested = 1;
+    pthread_join(loader->thread, NULL);
+    int ok = loader->progress.stage == LOAD_READY;
+
+    pthread_cond_destroy(&loader->changed);
+    pthread_mutex_destroy(&loader->mutex);
+    free(loader->citiesFile);
+    free(loader->roadsFile);
+    free(loader);
+    return ok;
+}
+
+/**
+ * Stage name
+ */
+const char *loadStageName(LoadStage stage)
+{
+    switch (stage)
+    {
+    case LOAD_CITIES:
+        return "cities";
+    case LOAD_ROADS:
+        return "roads";
+    case LOAD_INDICES:
+        return "indices";
+    case LOAD_READY:
+        return "ready";
+    default:
+        return "failed";
+    }
+}
+
 // SAVE GRAPH TO FILES
 /**
  * Save graph to CSV files
@@ -213,6 +1293,15 @@ int saveGraphToFiles(Graph *g, const char *citiesFile, const char *roadsFile)
                     edge->destCityID,
                     edge->distance);
             roadCount++;
+            if (edge->flags & ROAD_TWO_WAY)
+            {
+                // Files keep one row per direction
+                fprintf(fp, "%d,%d,%d\n",
+                        edge->destCityID,
+                        g->cities[i].cityID,
+                        edge->distance);
+                roadCount++;
+            }
             edge = edge->next;
         }
     }
@@ -0,0 +1,321 @@
+#include "generator.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define GENERATOR_DENSITY 0.5   // Cities per minSpacing^2 area, below Poisson-disc packing
+#define GENERATOR_WINDOW 64     // Newest active cities to sample around
+
+// ==================== RANDOM NUMBERS ====================
+
+/**
+ * Next 64-bit random value (splitmix64)
+ * Fast, seedable, and identical on every platform, unlike rand()
+ */
+static uint64_t nextRandom(uint64_t* state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * Uniform double in [0, 1)
+ */
+static double randomUnit(uint64_t* state) {
+    return (nextRandom(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// ==================== SAMPLE GRID ====================
+
+/**
+ * Background grid for Poisson-disc sampling
+ * Cell size is radius/sqrt(2), so each cell holds at most one city
+ */
+typedef struct SampleGrid {
+    int* cells;         // City index per cell, -1 = empty
+    int width;          // Cells per row and column
+    double cellSize;
+    double side;        // World size of the square domain
+} SampleGrid;
+
+/**
+ * Grid cell holding a point
+ */
+static int gridCell(const SampleGrid* grid, double x, double y) {
+    int gx = (int)(x / grid->cellSize);
+    int gy = (int)(y / grid->cellSize);
+    return gy * grid->width + gx;
+}
+
+/**
+ * Check that no existing city lies within radius of (x, y)
+ */
+static int farEnough(const SampleGrid* grid, const double* xs, const double* ys,
+                     double x, double y, double radius) {
+    int gx = (int)(x / grid->cellSize);
+    int gy = (int)(y / grid->cellSize);
+    double r2 = radius * radius;
+
+    for (int cy = gy - 2; cy <= gy + 2; cy++) {
+        if (cy < 0 || cy >= grid->width) continue;
+        for (int cx = gx - 2; cx <= gx + 2; cx++) {
+            if (cx < 0 || cx >= grid->width) continue;
+            int j = grid->cells[cy * grid->width + cx];
+            if (j == -1) continue;
+            double dx = xs[j] - x, dy = ys[j] - y;
+            if (dx * dx + dy * dy < r2) return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Place cities with Bridson's algorithm
+ * parent[i] is the city i was sampled around
+ */
+static int placeCities(SampleGrid* grid, double* xs, double* ys, int* parent, int* active,
+                       int numCities, double radius, uint64_t* rng) {
+    int count = 0, numActive = 0;
+
+    xs[0] = floor(grid->side / 2);
+    ys[0] = floor(grid->side / 2);
+    parent[0] = -1;
+    grid->cells[gridCell(grid, xs[0], ys[0])] = 0;
+    active[numActive++] = 0;
+    count = 1;
+
+    while (count < numCities && numActive > 0) {
+        // Pick among the newest active cities: random enough, cache friendly
+        int window = numActive < GENERATOR_WINDOW ? numActive : GENERATOR_WINDOW;
+        int slot = numActive - 1 - (int)(nextRandom(rng) % (uint64_t)window);
+        int a = active[slot];
+        int placed = 0;
+        double start = 2.0 * M_PI * randomUnit(rng);
+
+        for (int attempt = 0; attempt < GENERATOR_ATTEMPTS; attempt++) {
+            // Evenly spaced angles just outside the radius pack densely in few tries
+            double angle = start + 2.0 * M_PI * attempt / GENERATOR_ATTEMPTS;
+            double dist = radius * (1.0 + 0.1 * randomUnit(rng));
+            double x = floor(xs[a] + dist * cos(angle) + 0.5);
+            double y = floor(ys[a] + dist * sin(angle) + 0.5);
+
+            if (x < 0 || y < 0 || x >= grid->side || y >= grid->side) continue;
+            if (!farEnough(grid, xs, ys, x, y, radius)) continue;
+
+            xs[count] = x;
+            ys[count] = y;
+            parent[count] = a;
+            grid->cells[gridCell(grid, x, y)] = count;
+            active[numActive++] = count;
+            count++;
+            placed = 1;
+            break;
+        }
+
+        // Nothing fits around this city any more
+        if (!placed) {
+            active[slot] = active[--numActive];
+        }
+    }
+
+    return count;
+}
+
+// ==================== ROADS ====================
+
+/**
+ * Find the k nearest cities to i by ring search over the grid
+ * Returns how many were found
+ */
+static int nearestCities(const SampleGrid* grid, const double* xs, const double* ys,
+                         int i, int k, int* out) {
+    double bestD[GENERATOR_MAX_NEIGHBOURS];
+    int found = 0;
+    int gx = (int)(xs[i] / grid->cellSize);
+    int gy = (int)(ys[i] / grid->cellSize);
+
+    for (int ring = 1; ring < grid->width; ring++) {
+        for (int cy = gy - ring; cy <= gy + ring; cy++) {
+            if (cy < 0 || cy >= grid->width) continue;
+            int edgeRow = (cy == gy - ring || cy == gy + ring);
+            int step = edgeRow ? 1 : 2 * ring;
+            for (int cx = gx - ring; cx <= gx + ring; cx += step) {
+                if (cx < 0 || cx >= grid->width) continue;
+                int j = grid->cells[cy * grid->width + cx];
+                if (j == -1) continue;
+
+                double dx = xs[j] - xs[i], dy = ys[j] - ys[i];
+                double d = dx * dx + dy * dy;
+                if (found == k && d >= bestD[k - 1]) continue;
+
+                // Insertion into the sorted best list
+                int pos = found < k ? found++ : k - 1;
+                while (pos > 0 && bestD[pos - 1] > d) {
+                    bestD[pos] = bestD[pos - 1];
+                    out[pos] = out[pos - 1];
+                    pos--;
+                }
+                bestD[pos] = d;
+                out[pos] = j;
+            }
+        }
+
+        // Unscanned cells are at least ring cells away
+        double reach = ring * grid->cellSize;
+        if (found == k && bestD[k - 1] <= reach * reach) break;
+    }
+    return found;
+}
+
+/**
+ * Order-independent key of a city pair
+ */
+static uint64_t pairKey(int a, int b) {
+    int lo = a < b ? a : b, hi = a < b ? b : a;
+    return ((uint64_t)(uint32_t)lo << 32) | (uint32_t)hi;
+}
+
+static int compareKeys(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+// ==================== GENERATOR ====================
+
+/**
+ * Fill config defaults
+ */
+void initGeneratorConfig(GeneratorConfig* config, int numCities) {
+    config->numCities = numCities;
+    config->minSpacing = GENERATOR_MIN_SPACING;
+    config->neighbours = GENERATOR_NEIGHBOURS;
+    config->seed = 42;
+}
+
+/**
+ * Generate and write a random map
+ */
+int generateRandomMap(const GeneratorConfig* config, const char* citiesFile, const char* roadsFile) {
+    if (!config || config->numCities <= 0 || config->minSpacing < 2) {
+        printf("Error: Invalid generator settings!\n");
+        return 0;
+    }
+
+    int n = config->numCities;
+    int k = config->neighbours;
+    if (k < 0) k = 0;
+    if (k > GENERATOR_MAX_NEIGHBOURS) k = GENERATOR_MAX_NEIGHBOURS;
+
+    double radius = config->minSpacing;
+    SampleGrid grid;
+    grid.cellSize = radius / sqrt(2.0);
+    grid.side = ceil(sqrt(n / GENERATOR_DENSITY) * radius + 2 * radius);
+    grid.width = (int)ceil(grid.side / grid.cellSize);
+    if ((double)grid.width * grid.width > 2e9) {
+        printf("Error: Map too large to generate!\n");
+        return 0;
+    }
+
+    uint64_t rng = config->seed;
+    size_t maxPairs = (size_t)n * (k + 1);
+    grid.cells = (int*)malloc((size_t)grid.width * grid.width * sizeof(int));
+    double* xs = (double*)malloc(n * sizeof(double));
+    double* ys = (double*)malloc(n * sizeof(double));
+    int* parent = (int*)malloc(n * sizeof(int));
+    int* active = (int*)malloc(n * sizeof(int));
+    uint64_t* pairs = (uint64_t*)malloc(maxPairs * sizeof(uint64_t));
+
+    if (!grid.cells || !xs || !ys || !parent || !active || !pairs) {
+        printf("Error: Memory allocation failed for generator!\n");
+        free(grid.cells);
+        free(xs);
+        free(ys);
+        free(parent);
+        free(active);
+        free(pairs);
+        return 0;
+    }
+
+    for (size_t c = 0; c < (size_t)grid.width * grid.width; c++) {
+        grid.cells[c] = -1;
+    }
+
+    int count = placeCities(&grid, xs, ys, parent, active, n, radius, &rng);
+    if (count < n) {
+        printf("Warning: Only %d of %d cities fit the map.\n", count, n);
+    }
+
+    // Spanning tree from sampling order, then k nearest neighbours
+    size_t numPairs = 0;
+    int nearest[GENERATOR_MAX_NEIGHBOURS];
+    for (int i = 0; i < count; i++) {
+        if (parent[i] != -1) {
+            pairs[numPairs++] = pairKey(i, parent[i]);
+        }
+        int found = k > 0 ? nearestCities(&grid, xs, ys, i, k, nearest) : 0;
+        for (int j = 0; j < found; j++) {
+            pairs[numPairs++] = pairKey(i, nearest[j]);
+        }
+    }
+    qsort(pairs, numPairs, sizeof(uint64_t), compareKeys);
+
+    FILE* cfp = fopen(citiesFile, "w");
+    FILE* rfp = cfp ? fopen(roadsFile, "w") : NULL;
+    if (!cfp || !rfp) {
+        printf("Error: Could not open output files!\n");
+        if (cfp) fclose(cfp);
+        free(grid.cells);
+        free(xs);
+        free(ys);
+        free(parent);
+        free(active);
+        free(pairs);
+        return 0;
+    }
+    setvbuf(cfp, NULL, _IOFBF, 1 << 20);
+    setvbuf(rfp, NULL, _IOFBF, 1 << 20);
+
+    fprintf(cfp, "CityID,CityName,X_Coord,Y_Coord\n");
+    for (int i = 0; i < count; i++) {
+        fprintf(cfp, "%d,City%d,%d,%d\n", i + 1, i + 1, (int)xs[i], (int)ys[i]);
+    }
+
+    fprintf(rfp, "FromCityID,ToCityID,Distance\n");
+    long numRoads = 0;
+    for (size_t p = 0; p < numPairs; p++) {
+        if (p > 0 && pairs[p] == pairs[p - 1]) continue;
+        int a = (int)(pairs[p] >> 32);
+        int b = (int)(pairs[p] & 0xFFFFFFFFu);
+        double dx = xs[a] - xs[b], dy = ys[a] - ys[b];
+        int distance = (int)ceil(sqrt(dx * dx + dy * dy) * (1.0 + GENERATOR_DETOUR * randomUnit(&rng)));
+        if (distance < 1) distance = 1;
+        fprintf(rfp, "%d,%d,%d\n", a + 1, b + 1, distance);
+        fprintf(rfp, "%d,%d,%d\n", b + 1, a + 1, distance);
+        numRoads++;
+    }
+
+    int ok = !ferror(cfp) && !ferror(rfp);
+    ok = (fclose(cfp) == 0) && ok;
+    ok = (fclose(rfp) == 0) && ok;
+
+    free(grid.cells);
+    free(xs);
+    free(ys);
+    free(parent);
+    free(active);
+    free(pairs);
+
+    if (!ok) {
+        printf("Error: Failed writing generated map!\n");
+        return 0;
+    }
+
+    printf("Generated %d cities and %ld two-way roads.\n", count, numRoads);
+    return count;
+}
@@ -1,4 +1,15 @@
 #include "graph.h"
+#include "memtrack.h"
+
+static int rebuildIDIndex(Graph* g);
+
+/**
+ * Block of edges; edges are never freed one by one, only reused
+ */
+typedef struct EdgeSlab {
+    struct EdgeSlab* next;
+    Edge edges[EDGE_SLAB_EDGES];
+} EdgeSlab;
 
 // GRAPH INITIALIZATION 
 
@@ -7,27 +18,39 @@
  * Allocates memory for graph and city array
  */
 Graph* createGraph(int initialCapacity) {
-    Graph* g = (Graph*)malloc(sizeof(Graph));
+    Graph* g = (Graph*)memAlloc(MEM_GRAPH, sizeof(Graph));
     if (!g) {
         printf("Error: Memory allocation failed for graph!\n");
         return NULL;
     }
     
-    g->cities = (City*)malloc(initialCapacity * sizeof(City));
+    g->cities = (City*)memAlloc(MEM_GRAPH, initialCapacity * sizeof(City));
     if (!g->cities) {
         printf("Error: Memory allocation failed for cities array!\n");
-        free(g);
+        memFree(g);
         return NULL;
     }
     
     g->numCities = 0;
     g->capacity = initialCapacity;
+    g->listener = NULL;
+    g->listenerData = NULL;
+    g->idSlots = NULL;
+    g->idMask = 0;
+    g->csr = NULL;
+    g->version = 0;
+    g->quiet = 0;
+    g->symmetric = 0;
+    g->edgeSlabs = NULL;
+    g->slabUsed = 0;
+    g->freeEdges = NULL;
     
     // Initialize cities - set adjacency lists to NULL
     for (int i = 0; i < initialCapacity; i++) {
         g->cities[i].adjList = NULL;
     }
     
+    rebuildIDIndex(g);
     return g;
 }
 
@@ -38,29 +61,146 @@ Graph* createGraph(int initialCapacity) {
 void freeGraph(Graph* g) {
     if (!g) return;
     
-    // Free all adjacency lists
-    for (int i = 0; i < g->numCities; i++) {
-        Edge* current = g->cities[i].adjList;
-        while (current) {
-            Edge* temp = current;
-            current = current->next;
-            free(temp);
+    // Edges live in slabs, no need to walk the adjacency lists
+    while (g->edgeSlabs) {
+        EdgeSlab* slab = g->edgeSlabs;
+        g->edgeSlabs = slab->next;
+        memFree(slab);
+    }
+    
+    freeCSR(g->csr);
+    memFree(g->idSlots);
+    memFree(g->cities);
+    memFree(g);
+}
+
+// ==================== CHANGE EVENTS ====================
+
+/**
+ * Register change listener
+ */
+void setGraphEventListener(Graph* g, GraphEventListener listener, void* userData) {
+    if (!g) return;
+    g->listener = listener;
+    g->listenerData = userData;
+}
+
+/**
+ * Deliver event to listener
+ */
+void emitGraphEvent(Graph* g, const GraphEvent* ev) {
+    if (g && g->listener && ev) {
+        g->listener(g, ev, g->listenerData);
+    }
+}
+
+/**
+ * Record a change - bump the version and drop derived data
+ */
+static void graphChanged(Graph* g) {
+    g->version++;
+    if (g->csr) {
+        freeCSR(g->csr);
+        g->csr = NULL;
+    }
+}
+
+/**
+ * Emit a city or road event
+ */
+static void notify(Graph* g, GraphEventType type, int cityID, int toCityID, int distance) {
+    graphChanged(g);
+    if (!g->listener) return;
+    GraphEvent ev = { type, cityID, toCityID, distance, NULL, 0 };
+    g->listener(g, &ev, g->listenerData);
+}
+
+// ==================== CITY ID INDEX ====================
+
+/**
+ * Slot holding cityID, or the empty slot where it belongs
+ */
+static int idSlot(Graph* g, int cityID) {
+    int i = (int)(((unsigned int)cityID * 2654435761u) & (unsigned int)g->idMask);
+    while (g->idSlots[i] != -1 && g->cities[g->idSlots[i]].cityID != cityID) {
+        i = (i + 1) & g->idMask;
+    }
+    return i;
+}
+
+/**
+ * Rebuild the ID table from the cities array, growing it as needed
+ */
+static int rebuildIDIndex(Graph* g) {
+    int size = 16;
+    while (size < 2 * g->numCities + 2) {
+        size <<= 1;
+    }
+    
+    if (!g->idSlots || size != g->idMask + 1) {
+        int* slots = (int*)memRealloc(MEM_GRAPH, g->idSlots, size * sizeof(int));
+        if (!slots) {
+            // findCityIndex falls back to a linear scan
+            memFree(g->idSlots);
+            g->idSlots = NULL;
+            g->idMask = 0;
+            return 0;
         }
+        g->idSlots = slots;
+        g->idMask = size - 1;
     }
     
-    free(g->cities);
-    free(g);
+    for (int i = 0; i < size; i++) {
+        g->idSlots[i] = -1;
+    }
+    for (int i = 0; i < g->numCities; i++) {
+        g->idSlots[idSlot(g, g->cities[i].cityID)] = i;
+    }
+    return 1;
+}
+
+// ==================== EDGE STORAGE ====================
+
+/**
+ * Take an edge from the free list or the newest slab
+ */
+static Edge* allocEdge(Graph* g) {
+    if (g->freeEdges) {
+        Edge* e = g->freeEdges;
+        g->freeEdges = e->next;
+        return e;
+    }
+    if (!g->edgeSlabs || g->slabUsed == EDGE_SLAB_EDGES) {
+        EdgeSlab* slab = (EdgeSlab*)memAlloc(MEM_EDGES, sizeof(EdgeSlab));
+        if (!slab) return NULL;
+        slab->next = g->edgeSlabs;
+        g->edgeSlabs = slab;
+        g->slabUsed = 0;
+    }
+    return &g->edgeSlabs->edges[g->slabUsed++];
+}
+
+/**
+ * Return an unlinked edge for reuse
+ */
+static void releaseEdge(Graph* g, Edge* e) {
+    e->next = g->freeEdges;
+    g->freeEdges = e;
 }
 
 // ==================== SEARCH OPERATIONS ====================
 
 /**
  * Find city index by ID
- * Linear search through cities array
+ * Hash lookup, linear scan if the ID table is unavailable
  */
 int findCityIndex(Graph* g, int cityID) {
     if (!g) return -1;
     
+    if (g->idSlots) {
+        return g->idSlots[idSlot(g, cityID)];
+    }
+    
     for (int i = 0; i < g->numCities; i++) {
         if (g->cities[i].cityID == cityID) {
             return i;
@@ -105,7 +245,7 @@ int addCity(Graph* g, int cityID, const char* cityName, int x, int y) {
     // Resize if needed (double capacity)
     if (g->numCities >= g->capacity) {
         g->capacity *= 2;
-        City* temp = (City*)realloc(g->cities, g->capacity * sizeof(City));
+        City* temp = (City*)memRealloc(MEM_GRAPH, g->cities, g->capacity * sizeof(City));
         if (!temp) {
             printf("Error: Memory reallocation failed!\n");
             return 0;
@@ -127,7 +267,16 @@ int addCity(Graph* g, int cityID, const char* cityName, int x, int y) {
     g->cities[g->numCities].adjList = NULL;
     
     g->numCities++;
-    printf("✓ City '%s' (ID: %d) added successfully!\n", cityName, cityID);
+    if (g->idSlots && 2 * g->numCities + 2 <= g->idMask + 1) {
+        g->idSlots[idSlot(g, cityID)] = g->numCities - 1;
+    } else {
+        rebuildIDIndex(g);
+    }
+    
+    if (!g->quiet) {
+        printf("✓ City '%s' (ID: %d) added successfully!\n", cityName, cityID);
+    }
+    notify(g, EVENT_CITY_ADDED, cityID, -1, 0);
     return 1;
 }
 
@@ -152,11 +301,16 @@ int deleteCity(Graph* g, int cityID) {
     while (current) {
         Edge* temp = current;
         current = current->next;
-        free(temp);
+        releaseEdge(g, temp);
     }
     
-    // Remove all edges pointing TO this city from other cities
-    for (int i = 0; i < g->numCities; i++) {
+    // Remove all edges pointing TO this city from other cities; a cached
+    // snapshot names the sources, otherwise scan every adjacency list
+    CSRGraph* csr = g->csr && g->csr->inOffsets ? g->csr : NULL;
+    int first = csr ? csr->inOffsets[index] : 0;
+    int last = csr ? csr->inOffsets[index + 1] : g->numCities;
+    for (int j = first; j < last; j++) {
+        int i = csr ? csr->sources[j] : j;
         if (i == index) continue;
         
         Edge* prev = NULL;
@@ -171,7 +325,7 @@ int deleteCity(Graph* g, int cityID) {
                 }
                 Edge* temp = curr;
                 curr = curr->next;
-                free(temp);
+                releaseEdge(g, temp);
             } else {
                 prev = curr;
                 curr = curr->next;
@@ -184,16 +338,49 @@ int deleteCity(Graph* g, int cityID) {
         g->cities[i] = g->cities[i + 1];
     }
     g->numCities--;
+    rebuildIDIndex(g);
     
-    printf("✓ City deleted successfully!\n");
+    if (!g->quiet) {
+        printf("✓ City deleted successfully!\n");
+    }
+    notify(g, EVENT_CITY_REMOVED, cityID, -1, 0);
     return 1;
 }
 
 // ==================== ROAD OPERATIONS ====================
 
+/**
+ * Stored edge from a city index to a city ID, or NULL
+ */
+static Edge* findEdge(Graph* g, int fromIndex, int toCityID) {
+    for (Edge* e = g->cities[fromIndex].adjList; e; e = e->next) {
+        if (e->destCityID == toCityID) return e;
+    }
+    return NULL;
+}
+
+/**
+ * Push a new one-way edge onto a city's list
+ */
+static Edge* insertEdge(Graph* g, int fromIndex, int toCityID, int distance) {
+    Edge* newEdge = allocEdge(g);
+    if (!newEdge) {
+        printf("Error: Memory allocation failed for edge!\n");
+        return NULL;
+    }
+    
+    newEdge->destCityID = toCityID;
+    newEdge->distance = distance;
+    newEdge->flags = 0;
+    newEdge->next = g->cities[fromIndex].adjList;
+    g->cities[fromIndex].adjList = newEdge;
+    return newEdge;
+}
+
 /**
  * Add directed road (edge) between two cities
- * Updates existing edge if already present
+ * Updates existing edge if already present; a two-way edge whose
+ * directions no longer match is split into two one-way edges
  */
 int addRoad(Graph* g, int fromCityID, int toCityID, int distance) {
     if (!g) {
@@ -209,44 +396,58 @@ int addRoad(Graph* g, int fromCityID, int toCityID, int distance) {
         return 0;
     }
     
-    if (distance <= 0) {
-        printf("Error: Distance must be positive!\n");
+    if (distance <= 0 || distance > ROAD_MAX_DISTANCE) {
+        printf("Error: Distance must be between 1 and %d km!\n", ROAD_MAX_DISTANCE);
         return 0;
     }
     
-    // Check if road already exists
-    Edge* current = g->cities[fromIndex].adjList;
-    while (current) {
-        if (current->destCityID == toCityID) {
+    // Check if road already exists, stored here or as the way back of a
+    // two-way edge at the other end
+    Edge* current = findEdge(g, fromIndex, toCityID);
+    Edge* back = current ? NULL : findEdge(g, toIndex, fromCityID);
+    if (back && !(back->flags & ROAD_TWO_WAY) && !(g->symmetric && back->distance == distance)) {
+        back = NULL;
+    }
+    
+    if (current || (back && (back->flags & ROAD_TWO_WAY))) {
+        Edge* road = current ? current : back;
+        if (!g->quiet) {
             printf("Road already exists! Updating distance from %d to %d km.\n", 
-                   current->distance, distance);
+                   road->distance, distance);
+        }
+        if ((road->flags & ROAD_TWO_WAY) && road->distance != distance) {
+            // The other direction keeps its distance as a one-way edge
+            if (current && !insertEdge(g, toIndex, fromCityID, current->distance)) return 0;
+            if (back && !insertEdge(g, fromIndex, toCityID, distance)) return 0;
+            road->flags &= ~ROAD_TWO_WAY;
+        }
+        if (current) {
             current->distance = distance;
-            return 1;
         }
-        current = current->next;
+        notify(g, EVENT_ROAD_UPDATED, fromCityID, toCityID, distance);
+        return 1;
     }
     
-    // Create new edge
-    Edge* newEdge = (Edge*)malloc(sizeof(Edge));
-    if (!newEdge) {
-        printf("Error: Memory allocation failed for edge!\n");
+    if (back) {
+        // Symmetric mode: the mirror road becomes two-way
+        back->flags |= ROAD_TWO_WAY;
+    } else if (!insertEdge(g, fromIndex, toCityID, distance)) {
         return 0;
     }
     
-    newEdge->destCityID = toCityID;
-    newEdge->distance = distance;
-    newEdge->next = g->cities[fromIndex].adjList;
-    g->cities[fromIndex].adjList = newEdge;
-    
-    printf("✓ Road added: %s → %s (%d km)\n", 
-           g->cities[fromIndex].cityName, 
-           g->cities[toIndex].cityName, 
-           distance);
+    if (!g->quiet) {
+        printf("✓ Road added: %s → %s (%d km)\n", 
+               g->cities[fromIndex].cityName, 
+               g->cities[toIndex].cityName, 
+               distance);
+    }
+    notify(g, EVENT_ROAD_ADDED, fromCityID, toCityID, distance);
     return 1;
 }
 
 /**
  * Remove road between two cities
+ * Removing one direction of a two-way edge leaves a one-way edge
  */
 int removeRoad(Graph* g, int fromCityID, int toCityID) {
     if (!g) {
@@ -255,9 +456,13 @@ int removeRoad(Graph* g, int fromCityID, int toCityID) {
     }
     
     int fromIndex = findCityIndex(g, fromCityID);
+    int toIndex = findCityIndex(g, toCityID);
     
+    // Quiet callers (imports, reload diffs) report their own failures
     if (fromIndex == -1) {
-        printf("Error: Source city not found!\n");
+        if (!g->quiet) {
+            printf("Error: Source city not found!\n");
+        }
         return 0;
     }
     
@@ -271,18 +476,472 @@ int removeRoad(Graph* g, int fromCityID, int toCityID) {
             } else {
                 g->cities[fromIndex].adjList = current->next;
             }
-            free(current);
-            printf("✓ Road removed successfully!\n");
+            if ((current->flags & ROAD_TWO_WAY) && toIndex != -1) {
+                // Keep the way back: move the edge to the other end
+                current->destCityID = fromCityID;
+                current->flags = 0;
+                current->next = g->cities[toIndex].adjList;
+                g->cities[toIndex].adjList = current;
+            } else {
+                releaseEdge(g, current);
+            }
+            if (!g->quiet) {
+                printf("✓ Road removed successfully!\n");
+            }
+            notify(g, EVENT_ROAD_REMOVED, fromCityID, toCityID, 0);
             return 1;
         }
         prev = current;
         current = current->next;
     }
     
-    printf("Error: Road not found!\n");
+    Edge* back = toIndex != -1 ? findEdge(g, toIndex, fromCityID) : NULL;
+    if (back && (back->flags & ROAD_TWO_WAY)) {
+        back->flags &= ~ROAD_TWO_WAY;
+        if (!g->quiet) {
+            printf("✓ Road removed successfully!\n");
+        }
+        notify(g, EVENT_ROAD_REMOVED, fromCityID, toCityID, 0);
+        return 1;
+    }
+    
+    if (!g->quiet) {
+        printf("Error: Road not found!\n");
+    }
     return 0;
 }
 
+/**
+ * Look up road distance
+ * Checks the source's list, then a two-way edge stored at the destination
+ */
+int getRoadDistance(Graph* g, int fromCityID, int toCityID) {
+    if (!g) return -1;
+    
+    int fromIndex = findCityIndex(g, fromCityID);
+    int toIndex = findCityIndex(g, toCityID);
+    if (fromIndex == -1 || toIndex == -1) return -1;
+    
+    Edge* e = findEdge(g, fromIndex, toCityID);
+    if (e) return e->distance;
+    
+    e = findEdge(g, toIndex, fromCityID);
+    return e && (e->flags & ROAD_TWO_WAY) ? e->distance : -1;
+}
+
+// ==================== BATCH OPERATIONS ====================
+
+/**
+ * Drop the edges of a city's list that lead to a doomed city index
+ */
+static void stripDoomedEdges(Graph* g, int index, const char* doomed) {
+    Edge* prev = NULL;
+    Edge* curr = g->cities[index].adjList;
+    while (curr) {
+        int target = findCityIndex(g, curr->destCityID);
+        if (target != -1 && doomed[target] == 1) {
+            Edge* temp = curr;
+            curr = curr->next;
+            if (prev) {
+                prev->next = curr;
+            } else {
+                g->cities[index].adjList = curr;
+            }
+            releaseEdge(g, temp);
+        } else {
+            prev = curr;
+            curr = curr->next;
+        }
+    }
+}
+
+/**
+ * All MUTATE_REMOVE_CITY entries at once; returns cities removed
+ */
+static int removeCities(Graph* g, const GraphMutation* ops, int count) {
+    int n = g->numCities;
+    char* doomed = (char*)memCalloc(MEM_GRAPH, n > 0 ? n : 1, 1);   // 1 = removed, 2 = has roads into one
+    int* removedIDs = (int*)memAlloc(MEM_GRAPH, (count > 0 ? count : 1) * sizeof(int));
+    if (!doomed || !removedIDs) {
+        // One by one instead
+        memFree(doomed);
+        memFree(removedIDs);
+        int removed = 0;
+        for (int k = 0; k < count; k++) {
+            if (ops[k].type == MUTATE_REMOVE_CITY && findCityIndex(g, ops[k].cityID) != -1) {
+                removed += deleteCity(g, ops[k].cityID);
+            }
+        }
+        return removed;
+    }
+    
+    int removed = 0;
+    for (int k = 0; k < count; k++) {
+        if (ops[k].type != MUTATE_REMOVE_CITY) continue;
+        int index = findCityIndex(g, ops[k].cityID);
+        if (index != -1 && !doomed[index]) {
+            doomed[index] = 1;
+            removed++;
+        }
+    }
+    
+    if (removed > 0) {
+        // A cached snapshot names the cities with roads into the removed
+        // ones; otherwise every list is checked
+        CSRGraph* csr = g->csr && g->csr->inOffsets ? g->csr : NULL;
+        if (csr) {
+            for (int i = 0; i < n; i++) {
+                if (doomed[i] != 1) continue;
+                for (int j = csr->inOffsets[i]; j < csr->inOffsets[i + 1]; j++) {
+                    if (!doomed[csr->sources[j]]) doomed[csr->sources[j]] = 2;
+                }
+            }
+        }
+        for (int i = 0; i < n; i++) {
+            if (doomed[i] == 2 || (!csr && !doomed[i])) {
+                stripDoomedEdges(g, i, doomed);
+            }
+        }
+        
+        // Free the removed cities' lists and close the gaps in one pass
+        int kept = 0, gone = 0;
+        for (int i = 0; i < n; i++) {
+            if (doomed[i] == 1) {
+                Edge* current = g->cities[i].adjList;
+                while (current) {
+                    Edge* temp = current;
+                    current = current->next;
+                    releaseEdge(g, temp);
+                }
+                removedIDs[gone++] = g->cities[i].cityID;
+                continue;
+            }
+            g->cities[kept++] = g->cities[i];
+        }
+        for (int i = kept; i < n; i++) {
+            g->cities[i].adjList = NULL;
+        }
+        g->numCities = kept;
+        rebuildIDIndex(g);
+        
+        for (int k = 0; k < gone; k++) {
+            notify(g, EVENT_CITY_REMOVED, removedIDs[k], -1, 0);
+        }
+    }
+    
+    memFree(doomed);
+    memFree(removedIDs);
+    return removed;
+}
+
+/**
+ * Rename or move a city in place
+ */
+static int updateCity(Graph* g, const GraphMutation* op) {
+    int index = findCityIndex(g, op->cityID);
+    if (index == -1) {
+        printf("Error: City with ID %d not found!\n", op->cityID);
+        return 0;
+    }
+    
+    City* c = &g->cities[index];
+    strncpy(c->cityName, op->cityName, MAX_CITY_NAME - 1);
+    c->cityName[MAX_CITY_NAME - 1] = '\0';
+    c->x = op->x;
+    c->y = op->y;
+    notify(g, EVENT_CITY_UPDATED, op->cityID, -1, 0);
+    return 1;
+}
+
+/**
+ * Apply a batch of changes
+ * City removals share one compaction and one ID index rebuild instead of
+ * paying for them per city
+ */
+int applyGraphMutations(Graph* g, const GraphMutation* ops, int count) {
+    if (!g || (!ops && count > 0)) {
+        printf("Error: Invalid parameters!\n");
+        return 0;
+    }
+    
+    int wasQuiet = g->quiet;
+    g->quiet = 1;
+    int applied = removeCities(g, ops, count);
+    
+    for (int k = 0; k < count; k++) {
+        if (ops[k].type == MUTATE_REMOVE_ROAD) {
+            applied += removeRoad(g, ops[k].cityID, ops[k].toCityID);
+        }
+    }
+    for (int k = 0; k < count; k++) {
+        if (ops[k].type == MUTATE_ADD_CITY) {
+            applied += addCity(g, ops[k].cityID, ops[k].cityName, ops[k].x, ops[k].y);
+        } else if (ops[k].type == MUTATE_UPDATE_CITY) {
+            applied += updateCity(g, &ops[k]);
+        }
+    }
+    for (int k = 0; k < count; k++) {
+        if (ops[k].type == MUTATE_SET_ROAD) {
+            applied += addRoad(g, ops[k].cityID, ops[k].toCityID, ops[k].distance);
+        }
+    }
+    
+    g->quiet = wasQuiet;
+    return applied;
+}
+
+// ==================== CSR OPERATIONS ====================
+
+/**
+ * Build the forward rows of a CSR snapshot
+ * Resolves each edge target through the city ID index and builds only the
+ * forward rows; buildCSR adds the transposed half
+ */
+static CSRGraph* buildForwardCSR(Graph* g) {
+    if (!g) return NULL;
+    
+    int n = g->numCities;
+    CSRGraph* csr = (CSRGraph*)memAlloc(MEM_INDICES, sizeof(CSRGraph));
+    if (!csr) {
+        printf("Error: Memory allocation failed for CSR!\n");
+        return NULL;
+    }
+    
+    // Count edges per row: each stored edge, plus the way back of a
+    // two-way edge in its destination's row; dangling targets are dropped
+    int* rowSize = (int*)memCalloc(MEM_INDICES, n + 1, sizeof(int));
+    if (!rowSize) {
+        printf("Error: Memory allocation failed for CSR!\n");
+        memFree(csr);
+        return NULL;
+    }
+    int m = 0, twoWay = 0;
+    for (int i = 0; i < n; i++) {
+        for (Edge* e = g->cities[i].adjList; e; e = e->next) {
+            int target = findCityIndex(g, e->destCityID);
+            if (target == -1) continue;
+            rowSize[i]++;
+            m++;
+            if (e->flags & ROAD_TWO_WAY) {
+                rowSize[target]++;
+                twoWay++;
+            }
+        }
+    }
+    m += twoWay;
+    
+    csr->numCities = n;
+    csr->numEdges = 0;
+    csr->offsets = (int*)memAlloc(MEM_INDICES, (n + 1) * sizeof(int));
+    csr->targets = (int*)memAlloc(MEM_INDICES, (m > 0 ? m : 1) * sizeof(int));
+    csr->weights = (int*)memAlloc(MEM_INDICES, (m > 0 ? m : 1) * sizeof(int));
+    csr->xs = (float*)memAlloc(MEM_INDICES, (n > 0 ? n : 1) * sizeof(float));
+    csr->ys = (float*)memAlloc(MEM_INDICES, (n > 0 ? n : 1) * sizeof(float));
+    csr->inOffsets = NULL;
+    csr->sources = NULL;
+    csr->inWeights = NULL;
+    csr->inEdgeIDs = NULL;
+    csr->reverseEdgeIDs = NULL;
+    if (!csr->offsets || !csr->targets || !csr->weights || !csr->xs || !csr->ys) {
+        printf("Error: Memory allocation failed for CSR!\n");
+        memFree(rowSize);
+        freeCSR(csr);
+        return NULL;
+    }
+    
+    // Row offsets; rowSize becomes each row's fill position
+    int k = 0;
+    for (int i = 0; i < n; i++) {
+        csr->offsets[i] = k;
+        k += rowSize[i];
+        rowSize[i] = csr->offsets[i];
+        csr->xs[i] = (float)g->cities[i].x;
+        csr->ys[i] = (float)g->cities[i].y;
+    }
+    csr->offsets[n] = k;
+    csr->numEdges = k;
+    
+    // Stored edges first, in adjacency list order, then the ways back
+    for (int pass = 0; pass < (twoWay > 0 ? 2 : 1); pass++) {
+        for (int i = 0; i < n; i++) {
+            for (Edge* e = g->cities[i].adjList; e; e = e->next) {
+                if (pass == 1 && !(e->flags & ROAD_TWO_WAY)) continue;
+                int target = findCityIndex(g, e->destCityID);
+                if (target == -1) continue;
+                int row = pass == 0 ? i : target;
+                csr->targets[rowSize[row]] = pass == 0 ? target : i;
+                csr->weights[rowSize[row]] = e->distance;
+                rowSize[row]++;
+            }
+        }
+    }
+    memFree(rowSize);
+    
+    return csr;
+}
+
+/**
+ * Bytes the transposed half of a snapshot takes
+ */
+static size_t transposedCSRBytes(const CSRGraph* csr) {
+    int m = csr->numEdges > 0 ? csr->numEdges : 1;
+    return (size_t)(csr->numCities + 1) * sizeof(int) + 4 * (size_t)m * sizeof(int);
+}
+
+/**
+ * Free the transposed half, leaving the forward rows
+ */
+static void dropTransposedCSR(CSRGraph* csr) {
+    memFree(csr->inOffsets);
+    memFree(csr->sources);
+    memFree(csr->inWeights);
+    memFree(csr->inEdgeIDs);
+    memFree(csr->reverseEdgeIDs);
+    csr->inOffsets = NULL;
+    csr->sources = NULL;
+    csr->inWeights = NULL;
+    csr->inEdgeIDs = NULL;
+    csr->reverseEdgeIDs = NULL;
+}
+
+/**
+ * Build the transposed half from the forward rows with one counting sort
+ * by destination
+ */
+static int transposeCSR(CSRGraph* csr) {
+    int n = csr->numCities;
+    int k = csr->numEdges;
+    int m = k > 0 ? k : 1;
+    csr->inOffsets = (int*)memCalloc(MEM_INDICES, n + 1, sizeof(int));
+    csr->sources = (int*)memAlloc(MEM_INDICES, m * sizeof(int));
+    csr->inWeights = (int*)memAlloc(MEM_INDICES, m * sizeof(int));
+    csr->inEdgeIDs = (int*)memAlloc(MEM_INDICES, m * sizeof(int));
+    csr->reverseEdgeIDs = (int*)memAlloc(MEM_INDICES, m * sizeof(int));
+    if (!csr->inOffsets || !csr->sources || !csr->inWeights || !csr->inEdgeIDs ||
+        !csr->reverseEdgeIDs) {
+        printf("Error: Memory allocation failed for CSR!\n");
+        dropTransposedCSR(csr);
+        return 0;
+    }
+    
+    // Count in-degrees, prefix sum, then place each edge
+    for (int e = 0; e < k; e++) {
+        csr->inOffsets[csr->targets[e] + 1]++;
+    }
+    for (int i = 0; i < n; i++) {
+        csr->inOffsets[i + 1] += csr->inOffsets[i];
+    }
+    for (int i = 0; i < n; i++) {
+        for (int e = csr->offsets[i]; e < csr->offsets[i + 1]; e++) {
+            int slot = csr->inOffsets[csr->targets[e]]++;
+            csr->sources[slot] = i;
+            csr->inWeights[slot] = csr->weights[e];
+            csr->inEdgeIDs[slot] = e;
+            csr->reverseEdgeIDs[e] = slot;
+        }
+    }
+    // Placement advanced each offset to the next city's start; shift back
+    for (int i = n; i > 0; i--) {
+        csr->inOffsets[i] = csr->inOffsets[i - 1];
+    }
+    csr->inOffsets[0] = 0;
+    
+    return 1;
+}
+
+/**
+ * Build CSR snapshot with both halves
+ */
+CSRGraph* buildCSR(Graph* g) {
+    CSRGraph* csr = buildForwardCSR(g);
+    if (csr && !transposeCSR(csr)) {
+        freeCSR(csr);
+        return NULL;
+    }
+    return csr;
+}
+
+/**
+ * Free CSR snapshot
+ */
+void freeCSR(CSRGraph* csr) {
+    if (!csr) return;
+    memFree(csr->offsets);
+    memFree(csr->targets);
+    memFree(csr->weights);
+    memFree(csr->xs);
+    memFree(csr->ys);
+    memFree(csr->inOffsets);
+    memFree(csr->sources);
+    memFree(csr->inWeights);
+    memFree(csr->inEdgeIDs);
+    memFree(csr->reverseEdgeIDs);
+    memFree(csr);
+}
+
+/**
+ * Build and cache CSR snapshot
+ */
+int prepareGraph(Graph* g) {
+    if (!g) return 0;
+    if (g->csr) return 1;
+    
+    // The forward rows are always cached; the transposed half is an
+    // optional index, skipped when it would exceed the memory budget
+    g->csr = buildForwardCSR(g);
+    if (!g->csr) return 0;
+    if (!memoryFits(transposedCSRBytes(g->csr))) {
+        noteMemoryRefusal("transposed CSR index");
+    } else {
+        transposeCSR(g->csr);
+    }
+    return 1;
+}
+
+/**
+ * Drop optional cached indices until the budget has room
+ */
+size_t trimGraphCaches(Graph* g, size_t needed) {
+    if (!g || !g->csr || !g->csr->inOffsets || memoryFits(needed)) return 0;
+    
+    size_t bytes = transposedCSRBytes(g->csr);
+    dropTransposedCSR(g->csr);
+    return bytes;
+}
+
+/**
+ * Cached snapshot, or a temporary one with the forward rows only
+ */
+CSRGraph* acquireCSR(Graph* g, int* temporary) {
+    if (g && g->csr) {
+        *temporary = 0;
+        return g->csr;
+    }
+    *temporary = 1;
+    return buildForwardCSR(g);
+}
+
+/**
+ * Snapshot with the transposed half, cached or temporary
+ */
+CSRGraph* acquireTransposedCSR(Graph* g, int* temporary) {
+    if (g && g->csr && g->csr->inOffsets) {
+        *temporary = 0;
+        return g->csr;
+    }
+    *temporary = 1;
+    return buildCSR(g);
+}
+
+/**
+ * Free snapshot if it was temporary
+ */
+void releaseCSR(CSRGraph* csr, int temporary) {
+    if (temporary) {
+        freeCSR(csr);
+    }
+}
+
 // ==================== DISPLAY FUNCTIONS ====================
 
 /**
@@ -354,22 +1013,33 @@ void displayCity(Graph* g, int cityID) {
     printf("╚══════════════════════════════════════════════════╝\n");
     printf("City: %s (ID: %d)\n", g->cities[index].cityName, g->cities[index].cityID);
     printf("Coordinates: (%d, %d)\n", g->cities[index].x, g->cities[index].y);
-    printf("\nOutgoing Roads:\n");
     
-    Edge* edge = g->cities[index].adjList;
-    if (!edge) {
+    // Both lists come from the snapshot, which expands two-way roads
+    int temporary;
+    CSRGraph* csr = acquireTransposedCSR(g, &temporary);
+    
+    printf("\nOutgoing Roads:\n");
+    if (csr && csr->offsets[index] == csr->offsets[index + 1]) {
         printf("  (No outgoing roads)\n");
-    } else {
-        while (edge) {
-            int destIndex = findCityIndex(g, edge->destCityID);
-            if (destIndex != -1) {
-                printf("  → %s (%d km)\n", 
-                       g->cities[destIndex].cityName, 
-                       edge->distance);
-            }
-            edge = edge->next;
+    } else if (csr) {
+        for (int e = csr->offsets[index]; e < csr->offsets[index + 1]; e++) {
+            printf("  → %s (%d km)\n", 
+                   g->cities[csr->targets[e]].cityName, 
+                   csr->weights[e]);
+        }
+    }
+    
+    printf("\nIncoming Roads:\n");
+    if (csr && csr->inOffsets[index] == csr->inOffsets[index + 1]) {
+        printf("  (No incoming roads)\n");
+    } else if (csr) {
+        for (int j = csr->inOffsets[index]; j < csr->inOffsets[index + 1]; j++) {
+            printf("  ← %s (%d km)\n",
+                   g->cities[csr->sources[j]].cityName,
+                   csr->inWeights[j]);
         }
     }
+    releaseCSR(csr, temporary);
     printf("════════════════════════════════════════════════════\n");
 }
 
@@ -394,6 +1064,8 @@ void sortCitiesByName(Graph* g) {
             }
         }
     }
+    rebuildIDIndex(g);
+    graphChanged(g);
     printf("✓ Cities sorted by name.\n");
 }
 
@@ -1,9 +1,18 @@
+#define _POSIX_C_SOURCE 200809L    // pthread_rwlock_t under -std=c11
 #include "graph.h"
 #include "algorithms.h"
 #include "fileio.h"
+#include "server.h"
+#include "generator.h"
+#include "memtrack.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <pthread.h>
+
+// Background load of the startup map; menu actions lock the graph
+static GraphLoader* graphLoader = NULL;
+static pthread_rwlock_t graphLock = PTHREAD_RWLOCK_INITIALIZER;
 
 // Function prototypes
 void displayMainMenu();
@@ -14,28 +23,77 @@ void handleRemoveRoad(Graph* g);
 void handleFastNavigation(Graph* g);
 void handleAnalysisMode(Graph* g);
 void handleSearchCity(Graph* g);
+void displayHopMatrix(Graph* g);
+void printAnytimeImprovement(PathResult* pr, double epsilon, void* userData);
 void clearScreen();
 void pause();
 void clearInputBuffer();
+int runServerMode(int symmetric);
+int runGenerateMode(int argc, char* argv[]);
+int runBenchmarkMode(int argc, char* argv[], int symmetric);
+void benchmarkSearches(Graph* g, const int* pairs, int numQueries, double epsilon, int batched,
+                       const char* name);
+void beginGraphAccess(int write);
+void endGraphAccess();
+int graphIndexing();
+void finishBackgroundLoad();
 
 // ==================== MAIN FUNCTION ====================
 
-int main() {
+int main(int argc, char* argv[]) {
+    if (argc > 1 && strcmp(argv[1], "--generate") == 0) {
+        return runGenerateMode(argc, argv);
+    }
+    
+    // --symmetric: store matching road pairs once as two-way edges
+    // --memory-budget <MB>: refuse optional indices and scratch beyond it
+    // --huge-pages off|thp|explicit: backing of large arrays
+    int symmetric = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--symmetric") == 0) symmetric = 1;
+        if (strcmp(argv[i], "--memory-budget") == 0) {
+            double mb = i + 1 < argc ? atof(argv[i + 1]) : 0;
+            if (mb <= 0) {
+                printf("Error: --memory-budget needs a size in MB!\n");
+                return 1;
+            }
+            setMemoryBudget((size_t)(mb * 1048576.0));
+        }
+        if (strcmp(argv[i], "--huge-pages") == 0) {
+            const char* mode = i + 1 < argc ? argv[i + 1] : "";
+            if (strcmp(mode, "off") == 0) setHugePageMode(HUGE_PAGES_OFF);
+            else if (strcmp(mode, "thp") == 0) setHugePageMode(HUGE_PAGES_TRANSPARENT);
+            else if (strcmp(mode, "explicit") == 0) setHugePageMode(HUGE_PAGES_EXPLICIT);
+            else {
+                printf("Error: --huge-pages needs off, thp or explicit!\n");
+                return 1;
+            }
+        }
+    }
+    if (argc > 1 && strcmp(argv[1], "--serve") == 0) {
+        return runServerMode(symmetric);
+    }
+    if (argc > 1 && strcmp(argv[1], "--benchmark") == 0) {
+        return runBenchmarkMode(argc, argv, symmetric);
+    }
+    
     Graph* cityGraph = createGraph(50);
     
     if (!cityGraph) {
         printf("Error: Failed to create graph!\n");
         return 1;
     }
+    cityGraph->symmetric = symmetric;
     
     printf("╔══════════════════════════════════════════════════╗\n");
     printf("║   CITY NAVIGATION SYSTEM - C BACKEND v1.0        ║\n");
     printf("║   (Use Python GUI for visualization)             ║\n");
     printf("╚══════════════════════════════════════════════════╝\n\n");
     
-    printf("Loading graph from files...\n\n");
+    printf("Loading graph from files in the background...\n\n");
     
-    if (!loadGraphFromFiles(cityGraph, CITIES_FILE, ROADS_FILE)) {
+    graphLoader = startGraphLoad(cityGraph, CITIES_FILE, ROADS_FILE, &graphLock, NULL, NULL);
+    if (!graphLoader && !loadGraphFromFiles(cityGraph, CITIES_FILE, ROADS_FILE)) {
         printf("⚠️  Warning: Could not load graph from files.\n");
         printf("Starting with empty graph.\n\n");
     }
@@ -55,6 +113,13 @@ int main() {
         }
         clearInputBuffer();
         
+        int writes = (choice >= 1 && choice <= 4) || choice == 9;
+        if (choice == 12) {
+            finishBackgroundLoad();
+        } else {
+            beginGraphAccess(writes);
+        }
+        
         switch (choice) {
             case 1:
                 handleInsertCity(cityGraph);
@@ -112,6 +177,12 @@ int main() {
         }
         
         if (running) {
+            // Rebuild the CSR cache an edit dropped, or every later query
+            // builds its own (the loader discards the one it was building)
+            if (writes && (!graphLoader || getLoadProgress(graphLoader, NULL) >= LOAD_INDICES)) {
+                prepareGraph(cityGraph);
+            }
+            endGraphAccess();
             pause();
         }
     }
@@ -119,6 +190,228 @@ int main() {
     return 0;
 }
 
+// ==================== SERVER MODE ====================
+
+int runServerMode(int symmetric) {
+    FILE* out = openProtocolOutput();
+    if (!out) {
+        printf("Error: Could not open response stream!\n");
+        return 1;
+    }
+    
+    Graph* cityGraph = createGraph(50);
+    if (!cityGraph) {
+        printf("Error: Failed to create graph!\n");
+        fclose(out);
+        return 1;
+    }
+    cityGraph->symmetric = symmetric;
+    
+    ServerConfig config;
+    initServerConfig(&config);
+    config.citiesFile = CITIES_FILE;
+    config.roadsFile = ROADS_FILE;
+    int ok = runServer(cityGraph, &config, stdin, out);
+    
+    freeGraph(cityGraph);
+    fclose(out);
+    return ok ? 0 : 1;
+}
+
+// ==================== GENERATOR MODE ====================
+
+/* city_nav --generate <numCities> [citiesFile roadsFile] [seed] */
+int runGenerateMode(int argc, char* argv[]) {
+    if (argc < 3 || atoi(argv[2]) <= 0) {
+        printf("Usage: %s --generate <numCities> [citiesFile roadsFile] [seed]\n", argv[0]);
+        return 1;
+    }
+    
+    GeneratorConfig config;
+    initGeneratorConfig(&config, atoi(argv[2]));
+    const char* citiesFile = argc > 4 ? argv[3] : CITIES_FILE;
+    const char* roadsFile = argc > 4 ? argv[4] : ROADS_FILE;
+    if (argc > 5) {
+        config.seed = strtoull(argv[5], NULL, 10);
+    }
+    
+    double start = currentTimeMs();
+    if (!generateRandomMap(&config, citiesFile, roadsFile)) {
+        return 1;
+    }
+    printf("Wrote %s and %s in %.2f s\n", citiesFile, roadsFile, (currentTimeMs() - start) / 1000.0);
+    return 0;
+}
+
+// ==================== BENCHMARK MODE ====================
+
+/* city_nav --benchmark <queries> [citiesFile roadsFile] [seed] [--flags] */
+int runBenchmarkMode(int argc, char* argv[], int symmetric) {
+    // Positional arguments end at the first flag
+    int positional = 2;
+    while (positional < argc && strncmp(argv[positional], "--", 2) != 0) positional++;
+    
+    int numQueries = positional > 2 ? atoi(argv[2]) : 0;
+    if (numQueries <= 0) {
+        printf("Usage: %s --benchmark <queries> [citiesFile roadsFile] [seed]\n", argv[0]);
+        return 1;
+    }
+    const char* citiesFile = positional > 4 ? argv[3] : CITIES_FILE;
+    const char* roadsFile = positional > 4 ? argv[4] : ROADS_FILE;
+    unsigned int seed = positional > 5 ? (unsigned int)strtoul(argv[5], NULL, 10) : 1;
+    
+    Graph* g = createGraph(50);
+    if (!g) {
+        printf("Error: Failed to create graph!\n");
+        return 1;
+    }
+    g->symmetric = symmetric;
+    g->quiet = 1;
+    double start = currentTimeMs();
+    if (!loadGraphFromFiles(g, citiesFile, roadsFile) || g->numCities == 0 || !prepareGraph(g)) {
+        printf("Error: Could not load %s and %s!\n", citiesFile, roadsFile);
+        freeGraph(g);
+        return 1;
+    }
+    printf("Loaded %d cities, %d roads in %.1f ms (prefetch distance %d)\n", g->numCities,
+           g->csr->numEdges, currentTimeMs() - start, SEARCH_PREFETCH_DISTANCE);
+    
+    // Same random pairs for every kind of search
+    int* pairs = (int*)malloc(2 * (size_t)numQueries * sizeof(int));
+    int* hops = (int*)malloc((size_t)MSBFS_BATCH * g->numCities * sizeof(int));
+    if (!pairs || !hops) {
+        printf("Error: Memory allocation failed!\n");
+        free(pairs);
+        free(hops);
+        freeGraph(g);
+        return 1;
+    }
+    srand(seed);
+    for (int i = 0; i < 2 * numQueries; i++) {
+        pairs[i] = g->cities[rand() % g->numCities].cityID;
+    }
+    
+    benchmarkSearches(g, pairs, numQueries, 0.0, 0, "dijkstra");
+    benchmarkSearches(g, pairs, numQueries, 0.0, 1, "dijkstra*");
+    benchmarkSearches(g, pairs, numQueries, 1.0, 0, "astar");
+    benchmarkSearches(g, pairs, numQueries, 1.0, 1, "astar*");
+    
+    // One multi-source BFS pass over the first sources of the pairs
+    int numSources = numQueries < MSBFS_BATCH ? numQueries : MSBFS_BATCH;
+    start = currentTimeMs();
+    if (multiSourceBFS(g, pairs, numSources, hops, NULL)) {
+        long long checksum = 0;
+        for (long i = 0; i < (long)numSources * g->numCities; i++) {
+            checksum += hops[i];
+        }
+        printf("%-9s %8.3f ms/pass   (%d sources)      checksum %lld\n", "msbfs",
+               currentTimeMs() - start, numSources, checksum);
+    }
+    
+    free(pairs);
+    free(hops);
+    freeGraph(g);
+    return 0;
+}
+
+/* Time one search kind over the benchmark pairs; batched (*) runs them
+ * interleaved through searchBatch */
+void benchmarkSearches(Graph* g, const int* pairs, int numQueries, double epsilon, int batched,
+                       const char* name) {
+    SearchStats stats = {0, 0};
+    SearchOptions opts;
+    initSearchOptions(&opts);
+    opts.epsilon = epsilon;
+    opts.stats = &stats;
+    
+    long long checksum = 0;
+    double start = currentTimeMs();
+    if (batched) {
+        int* sources = (int*)malloc(numQueries * sizeof(int));
+        int* dests = (int*)malloc(numQueries * sizeof(int));
+        dist_t* distances = (dist_t*)malloc(numQueries * sizeof(dist_t));
+        if (!sources || !dests || !distances) {
+            printf("Error: Memory allocation failed!\n");
+            free(sources);
+            free(dests);
+            free(distances);
+            return;
+        }
+        for (int q = 0; q < numQueries; q++) {
+            sources[q] = pairs[2 * q];
+            dests[q] = pairs[2 * q + 1];
+        }
+        start = currentTimeMs();
+        if (searchBatch(g, sources, dests, numQueries, &opts, distances, NULL, NULL)) {
+            for (int q = 0; q < numQueries; q++) {
+                if (distances[q] != INF) checksum += distances[q];
+            }
+        }
+        free(sources);
+        free(dests);
+        free(distances);
+    } else {
+        for (int q = 0; q < numQueries; q++) {
+            PathResult* pr = searchPath(g, pairs[2 * q], pairs[2 * q + 1], &opts, NULL);
+            if (pr && pr->pathLength > 0) {
+                checksum += pr->totalDistance;
+            }
+            freePathResult(pr);
+        }
+    }
+    double ms = currentTimeMs() - start;
+    printf("%-9s %8.3f ms/query %7.1f M roads/s  checksum %lld\n", name, ms / numQueries,
+           ms > 0 ? stats.relaxed / (ms * 1000.0) : 0.0, checksum);
+}
+
+// ==================== BACKGROUND LOADING ====================
+
+/* Lock the graph for one menu action, waiting for the base graph if needed */
+void beginGraphAccess(int write) {
+    static int failureReported = 0;
+    
+    if (graphLoader) {
+        LoadProgress p;
+        if (getLoadProgress(graphLoader, &p) < LOAD_INDICES) {
+            printf("\n⏳ Map still loading (%s: %ld cities, %ld roads so far)...\n",
+                   loadStageName(p.stage), p.citiesLoaded, p.roadsLoaded);
+        }
+    }
+    
+    if (write) {
+        pthread_rwlock_wrlock(&graphLock);
+    } else {
+        pthread_rwlock_rdlock(&graphLock);
+    }
+    
+    if (graphLoader && !failureReported && getLoadProgress(graphLoader, NULL) == LOAD_FAILED) {
+        printf("⚠️  Warning: Could not load graph from files.\n");
+        printf("Continuing with the cities and roads that were read.\n\n");
+        failureReported = 1;
+    }
+}
+
+void endGraphAccess() {
+    pthread_rwlock_unlock(&graphLock);
+}
+
+/* Base graph is in but the CSR cache is not - A* would rebuild it per query */
+int graphIndexing() {
+    return graphLoader && getLoadProgress(graphLoader, NULL) == LOAD_INDICES;
+}
+
+/* Let the load complete (never save a half-loaded map), then join it */
+void finishBackgroundLoad() {
+    if (!graphLoader) return;
+    
+    if (getLoadProgress(graphLoader, NULL) < LOAD_READY) {
+        printf("\n⏳ Waiting for the map to finish loading...\n");
+    }
+    waitGraphLoad(graphLoader, LOAD_READY);
+    finishGraphLoad(graphLoader);
+    graphLoader = NULL;
+}
+
 // ==================== MENU DISPLAY ====================
 
 void displayMainMenu() {
@@ -303,6 +596,8 @@ void handleFastNavigation(Graph* g) {
     printf("╚══════════════════════════════════════════════════╝\n\n");
     printf("1. 🔍 Dijkstra's Algorithm (Guaranteed shortest)\n");
     printf("2. ⭐ A* Algorithm (Faster with heuristic)\n");
+    printf("3. ⚡ Weighted A* (Near-optimal, faster)\n");
+    printf("4. ⏱️  Anytime A* (Best path within 5 ms)\n");
     printf("\nEnter choice: ");
     
     if (scanf("%d", &algorithm) != 1) {
@@ -311,6 +606,16 @@ void handleFastNavigation(Graph* g) {
         return;
     }
     
+    double epsilon = 1.0;
+    if (algorithm == 3) {
+        printf("Enter Epsilon (>= 1.0, e.g. 1.5): ");
+        if (scanf("%lf", &epsilon) != 1 || epsilon < 1.0) {
+            clearInputBuffer();
+            printf("❌ Invalid input! Epsilon must be at least 1.0.\n");
+            return;
+        }
+    }
+    
     printf("\nEnter Source City ID: ");
     if (scanf("%d", &sourceID) != 1) {
         clearInputBuffer();
@@ -327,13 +632,31 @@ void handleFastNavigation(Graph* g) {
     clearInputBuffer();
     
     PathResult* result = NULL;
+    SearchStats stats = {0, 0};
+    SearchOptions opts;
+    initSearchOptions(&opts);
+    opts.stats = &stats;
+    
+    if (algorithm >= 2 && algorithm <= 4 && graphIndexing()) {
+        printf("\nℹ️  Search index still building - using Dijkstra for now.\n");
+        algorithm = 1;
+    }
     
     if (algorithm == 1) {
         printf("\n🔄 Running Dijkstra's Algorithm...\n");
-        result = dijkstra(g, sourceID, destID);
+        result = searchPath(g, sourceID, destID, &opts, NULL);
     } else if (algorithm == 2) {
         printf("\n🔄 Running A* Algorithm...\n");
-        result = astar(g, sourceID, destID);
+        opts.epsilon = 1.0;
+        result = searchPath(g, sourceID, destID, &opts, NULL);
+    } else if (algorithm == 3) {
+        printf("\n🔄 Running Weighted A* (epsilon %.2f)...\n", epsilon);
+        opts.epsilon = epsilon;
+        result = searchPath(g, sourceID, destID, &opts, NULL);
+    } else if (algorithm == 4) {
+        printf("\n🔄 Running Anytime A*...\n");
+        result = astarAnytime(g, sourceID, destID, 2.5, 0.5, 5.0,
+                              printAnytimeImprovement, NULL, NULL);
     } else {
         printf("\n❌ Invalid algorithm choice!\n");
         return;
@@ -341,6 +664,9 @@ void handleFastNavigation(Graph* g) {
     
     if (result && result->pathLength > 0) {
         displayPath(g, result);
+        if (stats.settled > 0) {
+            printf("Explored %ld cities and %ld roads\n", stats.settled, stats.relaxed);
+        }
         
         int srcIdx = findCityIndex(g, sourceID);
         int destIdx = findCityIndex(g, destID);
@@ -359,6 +685,11 @@ void handleFastNavigation(Graph* g) {
     freePathResult(result);
 }
 
+void printAnytimeImprovement(PathResult* pr, double epsilon, void* userData) {
+    (void)userData;
+    printf("   ↳ epsilon %.2f: " DIST_FMT " km (%d cities)\n", epsilon, pr->totalDistance, pr->pathLength);
+}
+
 void handleAnalysisMode(Graph* g) {
     int choice, cityID;
     
@@ -367,6 +698,8 @@ void handleAnalysisMode(Graph* g) {
     printf("╚══════════════════════════════════════════════════╝\n\n");
     printf("1. 🌊 BFS Traversal (Breadth-First)\n");
     printf("2. 🌲 DFS Traversal (Depth-First)\n");
+    printf("3. 🧮 Hop-Distance Matrix (All Cities)\n");
+    printf("4. 📊 Graph Statistics\n");
     printf("\nEnter choice: ");
     
     if (scanf("%d", &choice) != 1) {
@@ -375,6 +708,24 @@ void handleAnalysisMode(Graph* g) {
         return;
     }
     
+    if (choice == 3) {
+        clearInputBuffer();
+        displayHopMatrix(g);
+        logOperation("Hop-distance matrix computed");
+        return;
+    }
+    
+    if (choice == 4) {
+        clearInputBuffer();
+        GraphStats stats;
+        if (graphStats(g, &stats, 0)) {
+            displayGraphStats(&stats);
+            displayMemStats();
+            logOperation("Graph statistics computed");
+        }
+        return;
+    }
+    
     printf("\nEnter Start City ID: ");
     if (scanf("%d", &cityID) != 1) {
         clearInputBuffer();
@@ -384,10 +735,10 @@ void handleAnalysisMode(Graph* g) {
     clearInputBuffer();
     
     if (choice == 1) {
-        BFS(g, cityID);
+        BFS(g, cityID, NULL);
         logOperation("BFS traversal performed");
     } else if (choice == 2) {
-        DFS(g, cityID);
+        DFS(g, cityID, NULL);
         logOperation("DFS traversal performed");
     } else {
         printf("\n❌ Invalid choice!\n");
@@ -415,6 +766,56 @@ void handleSearchCity(Graph* g) {
     }
 }
 
+void displayHopMatrix(Graph* g) {
+    int n = g->numCities;
+    if (n == 0) {
+        printf("\n❌ Graph is empty!\n");
+        return;
+    }
+    
+    int* sources = (int*)calloc(n, sizeof(int));
+    int* hops = (int*)malloc((size_t)n * n * sizeof(int));
+    if (!sources || !hops) {
+        free(sources);
+        free(hops);
+        printf("❌ Memory allocation failed!\n");
+        return;
+    }
+    
+    for (int i = 0; i < n; i++) {
+        sources[i] = g->cities[i].cityID;
+    }
+    
+    if (multiSourceBFS(g, sources, n, hops, NULL)) {
+        printf("\n╔══════════════════════════════════════════════════╗\n");
+        printf("║         HOP-DISTANCE MATRIX                      ║\n");
+        printf("╚══════════════════════════════════════════════════╝\n");
+        printf("(rows = from, columns = to by city ID, - = unreachable)\n\n");
+        
+        printf("%-14s", "");
+        for (int j = 0; j < n; j++) {
+            printf("%5d", g->cities[j].cityID);
+        }
+        printf("\n");
+        for (int i = 0; i < n; i++) {
+            printf("%-14.14s", g->cities[i].cityName);
+            for (int j = 0; j < n; j++) {
+                int h = hops[(size_t)i * n + j];
+                if (h < 0) {
+                    printf("%5s", "-");
+                } else {
+                    printf("%5d", h);
+                }
+            }
+            printf("\n");
+        }
+        printf("════════════════════════════════════════════════════\n");
+    }
+    
+    free(sources);
+    free(hops);
+}
+
 // ==================== UTILITY FUNCTIONS ====================
 
 void clearScreen() {
@@ -0,0 +1,320 @@
+#define _GNU_SOURCE    // MAP_ANONYMOUS, MAP_HUGETLB and MADV_HUGEPAGE are Linux extensions
+#include "memtrack.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+/**
+ * Prepended to every tracked block: its size, owner and mapping
+ */
+typedef union MemHeader
+{
+    struct
+    {
+        size_t size;    // Including this header
+        size_t mapped;  // Length of the block's own mapping, 0 from malloc
+        int sys;
+    } info;
+    max_align_t align;  // Keeps the caller's block aligned
+} MemHeader;
+
+// COUNTERS
+static pthread_mutex_t memLock = PTHREAD_MUTEX_INITIALIZER;
+static size_t memBytes[NUM_MEM_SUBSYSTEMS];
+static size_t memTotal;
+static size_t memPeak;
+static size_t memBudget;
+static long memRefusals;
+static size_t memMapped;
+static long memHugeFallbacks;
+static HugePageMode hugeMode = HUGE_PAGES_TRANSPARENT;
+
+static const char *const subsystemNames[NUM_MEM_SUBSYSTEMS] = {
+    "graph", "edges", "indices", "search", "reload", "server"};
+
+/**
+ * Move a block onto (sign > 0) or off the counters
+ */
+static void charge(int sys, size_t bytes, size_t mapped, int sign)
+{
+    pthread_mutex_lock(&memLock);
+    if (sign > 0)
+    {
+        memBytes[sys] += bytes;
+        memTotal += bytes;
+        memMapped += mapped;
+        if (memTotal > memPeak)
+            memPeak = memTotal;
+    }
+    else
+    {
+        memBytes[sys] -= bytes;
+        memTotal -= bytes;
+        memMapped -= mapped;
+    }
+    pthread_mutex_unlock(&memLock);
+}
+
+// LARGE BLOCKS
+
+/**
+ * Set huge page backing
+ */
+void setHugePageMode(HugePageMode mode)
+{
+    pthread_mutex_lock(&memLock);
+    hugeMode = mode;
+    pthread_mutex_unlock(&memLock);
+}
+
+/**
+ * Map a huge-page aligned region of at least bytes; NULL to use malloc
+ */
+static void *mapLarge(size_t bytes, size_t *length)
+{
+#if defined(__linux__)
+    size_t len = (bytes + MEM_HUGE_PAGE_SIZE - 1) & ~(size_t)(MEM_HUGE_PAGE_SIZE - 1);
+    pthread_mutex_lock(&memLock);
+    HugePageMode mode = hugeMode;
+    pthread_mutex_unlock(&memLock);
+    if (mode == HUGE_PAGES_OFF)
+        return NULL;
+
+#ifdef MAP_HUGETLB
+    if (mode == HUGE_PAGES_EXPLICIT)
+    {
+        void *p = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED)
+        {
+            *length = len;
+            return p;
+        }
+        // No reserved pages (left); stop asking for them
+        printf("⚠️  No hugetlbfs pages available, using transparent huge pages\n");
+        setHugePageMode(HUGE_PAGES_TRANSPARENT);
+    }
+#endif
+
+    // Over-map by one huge page and trim, so the region starts on a boundary
+    char *raw = (char *)mmap(NULL, len + MEM_HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED)
+    {
+        pthread_mutex_lock(&memLock);
+        memHugeFallbacks++;
+        pthread_mutex_unlock(&memLock);
+        return NULL;
+    }
+    size_t head = (MEM_HUGE_PAGE_SIZE - (uintptr_t)raw % MEM_HUGE_PAGE_SIZE) % MEM_HUGE_PAGE_SIZE;
+    char *start = raw + head;
+    if (head > 0)
+        munmap(raw, head);
+    munmap(start + len, MEM_HUGE_PAGE_SIZE - head);
+#ifdef MADV_HUGEPAGE
+    madvise(start, len, MADV_HUGEPAGE); // Advisory; THP may be disabled system-wide
+#endif
+    *length = len;
+    return start;
+#else
+    (void)bytes;
+    (void)length;
+    return NULL;
+#endif
+}
+
+/**
+ * Allocate and charge a block; large ones get their own mapping
+ */
+static void *allocBlock(int sys, size_t size, int zero)
+{
+    if (size > SIZE_MAX - sizeof(MemHeader) - MEM_HUGE_PAGE_SIZE)
+        return NULL;
+    size_t total = sizeof(MemHeader) + size;
+    size_t mapped = 0;
+    // Fresh mappings are already zeroed
+    MemHeader *h = total >= MEM_HUGE_BLOCK_BYTES ? (MemHeader *)mapLarge(total, &mapped) : NULL;
+    if (!h)
+        h = (MemHeader *)(zero ? calloc(1, total) : malloc(total));
+    if (!h)
+        return NULL;
+    h->info.size = total;
+    h->info.mapped = mapped;
+    h->info.sys = sys;
+    charge(sys, total, mapped, 1);
+    return h + 1;
+}
+
+// TRACKED ALLOCATION
+
+/**
+ * Tracked malloc
+ */
+void *memAlloc(MemSubsystem sys, size_t size)
+{
+    return allocBlock(sys, size, 0);
+}
+
+/**
+ * Tracked calloc
+ */
+void *memCalloc(MemSubsystem sys, size_t count, size_t size)
+{
+    if (size && count > (SIZE_MAX - sizeof(MemHeader)) / size)
+        return NULL;
+    return allocBlock(sys, count * size, 1);
+}
+
+/**
+ * Tracked realloc
+ */
+void *memRealloc(MemSubsystem sys, void *ptr, size_t size)
+{
+    if (!ptr)
+        return memAlloc(sys, size);
+    if (size > SIZE_MAX - sizeof(MemHeader) - MEM_HUGE_PAGE_SIZE)
+        return NULL;
+
+    MemHeader *old = (MemHeader *)ptr - 1;
+    size_t oldSize = old->info.size;
+    size_t total = sizeof(MemHeader) + size;
+    if (!old->info.mapped && total < MEM_HUGE_BLOCK_BYTES)
+    {
+        int oldSys = old->info.sys;
+        MemHeader *h = (MemHeader *)realloc(old, total);
+        if (!h)
+            return NULL;
+        h->info.size = total;
+        h->info.sys = sys;
+        charge(oldSys, oldSize, 0, -1);
+        charge(sys, total, 0, 1);
+        return h + 1;
+    }
+    if (old->info.mapped && total <= old->info.mapped && total >= MEM_HUGE_BLOCK_BYTES)
+    {
+        // Still fits the mapping
+        charge(old->info.sys, oldSize, old->info.mapped, -1);
+        old->info.size = total;
+        old->info.sys = sys;
+        charge(sys, total, old->info.mapped, 1);
+        return ptr;
+    }
+
+    // Into or out of a mapping: move
+    void *moved = allocBlock(sys, size, 0);
+    if (!moved)
+        return NULL;
+    memcpy(moved, ptr, (oldSize < total ? oldSize : total) - sizeof(MemHeader));
+    memFree(ptr);
+    return moved;
+}
+
+/**
+ * Tracked free
+ */
+void memFree(void *ptr)
+{
+    if (!ptr)
+        return;
+    MemHeader *h = (MemHeader *)ptr - 1;
+    charge(h->info.sys, h->info.size, h->info.mapped, -1);
+#if defined(__linux__)
+    if (h->info.mapped)
+    {
+        munmap(h, h->info.mapped);
+        return;
+    }
+#endif
+    free(h);
+}
+
+// MEMORY BUDGET
+
+/**
+ * Set budget
+ */
+void setMemoryBudget(size_t bytes)
+{
+    pthread_mutex_lock(&memLock);
+    memBudget = bytes;
+    pthread_mutex_unlock(&memLock);
+}
+
+/**
+ * Budget check
+ */
+int memoryFits(size_t bytes)
+{
+    pthread_mutex_lock(&memLock);
+    int fits = memBudget == 0 || (memTotal <= memBudget && bytes <= memBudget - memTotal);
+    pthread_mutex_unlock(&memLock);
+    return fits;
+}
+
+/**
+ * Count a refusal
+ */
+void noteMemoryRefusal(const char *what)
+{
+    pthread_mutex_lock(&memLock);
+    memRefusals++;
+    size_t total = memTotal, budget = memBudget;
+    pthread_mutex_unlock(&memLock);
+    printf("⚠️  Memory budget: %s skipped (%.1f of %.1f MB in use)\n", what,
+           total / 1048576.0, budget / 1048576.0);
+}
+
+/**
+ * Snapshot of counters
+ */
+void getMemStats(MemStats *stats)
+{
+    if (!stats)
+        return;
+    pthread_mutex_lock(&memLock);
+    memcpy(stats->bytes, memBytes, sizeof(memBytes));
+    stats->total = memTotal;
+    stats->peak = memPeak;
+    stats->budget = memBudget;
+    stats->refusals = memRefusals;
+    stats->mapped = memMapped;
+    stats->hugeFallbacks = memHugeFallbacks;
+    pthread_mutex_unlock(&memLock);
+}
+
+/**
+ * Subsystem name
+ */
+const char *memSubsystemName(MemSubsystem sys)
+{
+    return sys >= 0 && sys < NUM_MEM_SUBSYSTEMS ? subsystemNames[sys] : "unknown";
+}
+
+/**
+ * Print counters
+ */
+void displayMemStats(void)
+{
+    MemStats stats;
+    getMemStats(&stats);
+
+    printf("\n--- Memory ---\n");
+    for (int i = 0; i < NUM_MEM_SUBSYSTEMS; i++)
+        printf("%-10s %10.2f MB\n", subsystemNames[i], stats.bytes[i] / 1048576.0);
+    printf("%-10s %10.2f MB (peak %.2f MB)\n", "total", stats.total / 1048576.0,
+           stats.peak / 1048576.0);
+    printf("%-10s %10.2f MB in huge-page aligned mappings", "mapped", stats.mapped / 1048576.0);
+    if (stats.hugeFallbacks)
+        printf(", %ld large blocks fell back to malloc", stats.hugeFallbacks);
+    printf("\n");
+    if (stats.budget)
+        printf("%-10s %10.2f MB, %ld refusals\n", "budget", stats.budget / 1048576.0,
+               stats.refusals);
+    else
+        printf("%-10s %10s\n", "budget", "unlimited");
+}
@@ -0,0 +1,460 @@
+#include "render.h"
+#include "memtrack.h"
+#include <math.h>
+#include <stdint.h>
+
+// CELL MAP
+/**
+ * Open-addressing hash map from a 64-bit key to an int value
+ * Used for grid cell -> cluster and cluster pair -> seen
+ */
+typedef struct KeyMap {
+    uint64_t *keys;
+    int *values;        // -1 = empty slot
+    size_t mask;        // Capacity - 1 (power of two)
+} KeyMap;
+
+static int initKeyMap(KeyMap *m, size_t expected)
+{
+    size_t cap = 16;
+    while (cap < expected * 2)
+        cap <<= 1;
+
+    m->keys = (uint64_t *)memAlloc(MEM_SERVER, cap * sizeof(uint64_t));
+    m->values = (int *)memAlloc(MEM_SERVER, cap * sizeof(int));
+    m->mask = cap - 1;
+    if (!m->keys || !m->values)
+    {
+        memFree(m->keys);
+        memFree(m->values);
+        return 0;
+    }
+    for (size_t i = 0; i < cap; i++)
+        m->values[i] = -1;
+    return 1;
+}
+
+static void freeKeyMap(KeyMap *m)
+{
+    memFree(m->keys);
+    memFree(m->values);
+}
+
+/* Return the value for key, inserting newValue if absent (sets *inserted) */
+static int keyMapGetOrInsert(KeyMap *m, uint64_t key, int newValue, int *inserted)
+{
+    size_t i = (size_t)((key * 0x9E3779B97F4A7C15ULL) >> 17) & m->mask;
+    while (m->values[i] != -1)
+    {
+        if (m->keys[i] == key)
+        {
+            *inserted = 0;
+            return m->values[i];
+        }
+        i = (i + 1) & m->mask;
+    }
+    m->keys[i] = key;
+    m->values[i] = newValue;
+    *inserted = 1;
+    return newValue;
+}
+
+static uint64_t cellKey(long cx, long cy)
+{
+    return ((uint64_t)(uint32_t)cx << 32) | (uint32_t)cy;
+}
+
+// RENDER FEED
+/* Segment bounding box overlaps the viewport */
+static int segmentVisible(const Viewport *vp, float x1, float y1, float x2, float y2)
+{
+    float loX = x1 < x2 ? x1 : x2, hiX = x1 < x2 ? x2 : x1;
+    float loY = y1 < y2 ? y1 : y2, hiY = y1 < y2 ? y2 : y1;
+    return hiX >= vp->minX && loX <= vp->maxX && hiY >= vp->minY && loY <= vp->maxY;
+}
+
+/* Build level-of-detail feed */
+RenderFeed *buildRenderFeed(Graph *g, const Viewport *vp, int clusterPx, int minEdgePx,
+                            const int *pathIDs, int pathLength)
+{
+    if (!g || !vp || vp->maxX <= vp->minX || vp->maxY <= vp->minY ||
+        vp->widthPx <= 0 || vp->heightPx <= 0)
+    {
+        printf("Error: Invalid viewport!\n");
+        return NULL;
+    }
+
+    if (clusterPx <= 0)
+        clusterPx = RENDER_CLUSTER_PX;
+    if (minEdgePx < 0)
+        minEdgePx = RENDER_MIN_EDGE_PX;
+
+    int n = g->numCities;
+    double scaleX = vp->widthPx / (vp->maxX - vp->minX);   // Pixels per world unit
+    double scaleY = vp->heightPx / (vp->maxY - vp->minY);
+    double cellW = clusterPx / scaleX;
+    double cellH = clusterPx / scaleY;
+
+    RenderFeed *feed = (RenderFeed *)memCalloc(MEM_SERVER, 1, sizeof(RenderFeed));
+    int tempCSR;
+    CSRGraph *csr = acquireCSR(g, &tempCSR);
+    int *clusterOf = (int *)memAlloc(MEM_SERVER, (n > 0 ? n : 1) * sizeof(int));
+    RenderCluster *all = (RenderCluster *)memAlloc(MEM_SERVER, (n > 0 ? n : 1) * sizeof(RenderCluster));
+    double *sumX = (double *)memCalloc(MEM_SERVER, n > 0 ? n : 1, sizeof(double));
+    double *sumY = (double *)memCalloc(MEM_SERVER, n > 0 ? n : 1, sizeof(double));
+    char *visible = (char *)memCalloc(MEM_SERVER, n > 0 ? n : 1, sizeof(char));
+    KeyMap cells, pairs;
+    int haveCells = initKeyMap(&cells, n);
+    int havePairs = csr ? initKeyMap(&pairs, csr->numEdges) : 0;
+
+    if (!feed || !csr || !clusterOf || !all || !sumX || !sumY || !visible || !haveCells || !havePairs)
+    {
+        printf("Error: Memory allocation failed for render feed!\n");
+        freeRenderFeed(feed);
+        releaseCSR(csr, tempCSR);
+        memFree(clusterOf);
+        memFree(all);
+        memFree(sumX);
+        memFree(sumY);
+        memFree(visible);
+        if (haveCells)
+            freeKeyMap(&cells);
+        if (havePairs)
+            freeKeyMap(&pairs);
+        return NULL;
+    }
+
+    // Assign every city to its screen cell
+    int numAll = 0;
+    for (int i = 0; i < n; i++)
+    {
+        City *c = &g->cities[i];
+        long cx = (long)floor((c->x - vp->minX) / cellW);
+        long cy = (long)floor((c->y - vp->minY) / cellH);
+        int inserted;
+        int k = keyMapGetOrInsert(&cells, cellKey(cx, cy), numAll, &inserted);
+        if (inserted)
+        {
+            all[k].count = 0;
+            all[k].cityID = c->cityID;
+            numAll++;
+        }
+        clusterOf[i] = k;
+        all[k].count++;
+        sumX[k] += c->x;
+        sumY[k] += c->y;
+        if (c->cityID < all[k].cityID)
+            all[k].cityID = c->cityID;
+        if (c->x >= vp->minX && c->x <= vp->maxX && c->y >= vp->minY && c->y <= vp->maxY)
+            visible[k] = 1;
+    }
+
+    for (int k = 0; k < numAll; k++)
+    {
+        all[k].x = (float)(sumX[k] / all[k].count);
+        all[k].y = (float)(sumY[k] / all[k].count);
+    }
+
+    // Emit visible clusters
+    feed->clusters = (RenderCluster *)memAlloc(MEM_SERVER, (numAll > 0 ? numAll : 1) * sizeof(RenderCluster));
+    feed->edges = (RenderSegment *)memAlloc(MEM_SERVER, (csr->numEdges > 0 ? csr->numEdges : 1) * sizeof(RenderSegment));
+    feed->path = (RenderPoint *)memAlloc(MEM_SERVER, (pathLength > 0 ? pathLength : 1) * sizeof(RenderPoint));
+    if (feed->clusters && feed->edges && feed->path)
+    {
+        for (int k = 0; k < numAll; k++)
+        {
+            if (visible[k])
+                feed->clusters[feed->numClusters++] = all[k];
+        }
+
+        // One segment per cluster pair, culled by length and viewport
+        double minLen2 = (double)minEdgePx * minEdgePx;
+        for (int u = 0; u < n; u++)
+        {
+            for (int e = csr->offsets[u]; e < csr->offsets[u + 1]; e++)
+            {
+                int a = clusterOf[u];
+                int b = clusterOf[csr->targets[e]];
+                if (a == b)
+                    continue;
+
+                int lo = a < b ? a : b, hi = a < b ? b : a;
+                int inserted;
+                keyMapGetOrInsert(&pairs, ((uint64_t)lo << 32) | (uint32_t)hi, 0, &inserted);
+                if (!inserted)
+                    continue;
+
+                double dx = (all[b].x - all[a].x) * scaleX;
+                double dy = (all[b].y - all[a].y) * scaleY;
+                if (dx * dx + dy * dy < minLen2)
+                    continue;
+                if (!segmentVisible(vp, all[a].x, all[a].y, all[b].x, all[b].y))
+                    continue;
+
+                RenderSegment *s = &feed->edges[feed->numEdges++];
+                s->x1 = all[a].x;
+                s->y1 = all[a].y;
+                s->x2 = all[b].x;
+                s->y2 = all[b].y;
+            }
+        }
+
+        // Highlighted path at full detail
+        for (int i = 0; i < pathLength; i++)
+        {
+            int idx = findCityIndex(g, pathIDs[i]);
+            if (idx == -1)
+                continue;
+            RenderPoint *p = &feed->path[feed->pathLength++];
+            p->cityID = pathIDs[i];
+            p->x = (float)g->cities[idx].x;
+            p->y = (float)g->cities[idx].y;
+        }
+    }
+
+    int ok = feed->clusters && feed->edges && feed->path;
+    releaseCSR(csr, tempCSR);
+    memFree(clusterOf);
+    memFree(all);
+    memFree(sumX);
+    memFree(sumY);
+    memFree(visible);
+    freeKeyMap(&cells);
+    freeKeyMap(&pairs);
+
+    if (!ok)
+    {
+        printf("Error: Memory allocation failed for render feed!\n");
+        freeRenderFeed(feed);
+        return NULL;
+    }
+    return feed;
+}
+
+/* Free render feed */
+void freeRenderFeed(RenderFeed *feed)
+{
+    if (!feed)
+        return;
+    memFree(feed->clusters);
+    memFree(feed->edges);
+    memFree(feed->path);
+    memFree(feed);
+}
+
+/* Write feed tokens */
+void writeRenderFeed(const RenderFeed *feed, FILE *out, int encodePath)
+{
+    fprintf(out, "%d %d %d", feed->numClusters, feed->numEdges, feed->pathLength);
+    for (int i = 0; i < feed->numClusters; i++)
+    {
+        const RenderCluster *c = &feed->clusters[i];
+        fprintf(out, " %.1f %.1f %d %d", c->x, c->y, c->count, c->cityID);
+    }
+    for (int i = 0; i < feed->numEdges; i++)
+    {
+        const RenderSegment *s = &feed->edges[i];
+        fprintf(out, " %.1f %.1f %.1f %.1f", s->x1, s->y1, s->x2, s->y2);
+    }
+
+    if (encodePath && feed->pathLength > 0)
+    {
+        int *xy = (int *)memAlloc(MEM_SERVER, (size_t)feed->pathLength * 2 * sizeof(int));
+        char *text = (char *)memAlloc(MEM_SERVER, (size_t)feed->pathLength * 2 * POLYLINE_MAX_CHARS + 1);
+        if (xy && text)
+        {
+            for (int i = 0; i < feed->pathLength; i++)
+            {
+                xy[2 * i] = (int)lroundf(feed->path[i].x);
+                xy[2 * i + 1] = (int)lroundf(feed->path[i].y);
+            }
+            encodePolyline(xy, feed->pathLength, 2, text);
+            fprintf(out, " %s", text);
+            memFree(xy);
+            memFree(text);
+            return;
+        }
+        memFree(xy);
+        memFree(text);
+    }
+
+    for (int i = 0; i < feed->pathLength; i++)
+    {
+        const RenderPoint *p = &feed->path[i];
+        fprintf(out, " %d %.1f %.1f", p->cityID, p->x, p->y);
+    }
+}
+
+// ROUTE GEOMETRY
+/* One zigzagged value in 5-bit groups, low group first */
+static size_t encodeValue(long long value, char *out)
+{
+    unsigned long long z = (unsigned long long)value << 1;
+    if (value < 0)
+        z = ~z;
+
+    size_t n = 0;
+    while (z >= 0x20)
+    {
+        out[n++] = (char)((0x20 | (z & 0x1f)) + 63);
+        z >>= 5;
+    }
+    out[n++] = (char)(z + 63);
+    return n;
+}
+
+/* Delta + zigzag + base64-ish polyline encoding */
+size_t encodePolyline(const int *values, int count, int dims, char *out)
+{
+    long long prev[POLYLINE_MAX_DIMS] = {0};
+    size_t n = 0;
+
+    if (dims < 1 || dims > POLYLINE_MAX_DIMS)
+        dims = 0;
+    for (int i = 0; i < count; i++)
+    {
+        for (int d = 0; d < dims; d++)
+        {
+            long long v = values[(size_t)i * dims + d];
+            n += encodeValue(v - prev[d], out + n);
+            prev[d] = v;
+        }
+    }
+    out[n] = '\0';
+    return n;
+}
+
+/* Inverse of encodePolyline */
+int decodePolyline(const char *text, int dims, int *values, int maxPoints)
+{
+    long long prev[POLYLINE_MAX_DIMS] = {0};
+    int count = 0, d = 0;
+
+    if (!text || dims < 1 || dims > POLYLINE_MAX_DIMS)
+        return -1;
+
+    while (*text)
+    {
+        unsigned long long z = 0;
+        int shift = 0, c;
+        do
+        {
+            c = *text++ - 63;
+            if (c < 0 || c > 63 || shift > 60)
+                return -1;
+            z |= (unsigned long long)(c & 0x1f) << shift;
+            shift += 5;
+        } while (c >= 0x20 && *text);
+        if (c >= 0x20)
+            return -1;
+
+        long long delta = (z & 1) ? ~(long long)(z >> 1) : (long long)(z >> 1);
+        prev[d] += delta;
+        if (count >= maxPoints)
+            return -1;
+        values[(size_t)count * dims + d] = (int)prev[d];
+        if (++d == dims)
+        {
+            d = 0;
+            count++;
+        }
+    }
+    return d == 0 ? count : -1;
+}
+
+/* Route coordinates as an x/y polyline */
+char *encodeRouteGeometry(Graph *g, const int *pathIDs, int pathLength)
+{
+    if (!g || !pathIDs || pathLength <= 0)
+        return NULL;
+
+    int *xy = (int *)memAlloc(MEM_SERVER, (size_t)pathLength * 2 * sizeof(int));
+    char *text = (char *)memAlloc(MEM_SERVER, (size_t)pathLength * 2 * POLYLINE_MAX_CHARS + 1);
+    if (!xy || !text)
+    {
+        printf("Error: Memory allocation failed for polyline!\n");
+        memFree(xy);
+        memFree(text);
+        return NULL;
+    }
+
+    for (int i = 0; i < pathLength; i++)
+    {
+        int idx = findCityIndex(g, pathIDs[i]);
+        if (idx == -1)
+        {
+            printf("Error: City %d not found!\n", pathIDs[i]);
+            memFree(xy);
+            memFree(text);
+            return NULL;
+        }
+        xy[2 * i] = g->cities[idx].x;
+        xy[2 * i + 1] = g->cities[idx].y;
+    }
+
+    encodePolyline(xy, pathLength, 2, text);
+    memFree(xy);
+    return text;
+}
+
+/* Shortest road from one city to another, counting two-way roads stored
+ * the other way round; -1 if none. Searches relax every parallel road, so
+ * this is the one a route took */
+static int shortestRoad(Graph *g, int fromID, int toID)
+{
+    int fromIndex = findCityIndex(g, fromID);
+    int toIndex = findCityIndex(g, toID);
+    if (fromIndex == -1 || toIndex == -1)
+        return -1;
+
+    int best = -1;
+    for (Edge *e = g->cities[fromIndex].adjList; e; e = e->next)
+    {
+        if (e->destCityID == toID && (best == -1 || e->distance < best))
+            best = e->distance;
+    }
+    for (Edge *e = g->cities[toIndex].adjList; e; e = e->next)
+    {
+        if (e->destCityID == fromID && (e->flags & ROAD_TWO_WAY) && (best == -1 || e->distance < best))
+            best = e->distance;
+    }
+    return best;
+}
+
+/* Cumulative route distances as a 1-D polyline */
+char *encodeRouteDistances(Graph *g, const int *pathIDs, int pathLength)
+{
+    if (!g || !pathIDs || pathLength <= 0)
+        return NULL;
+
+    int *cumulative = (int *)memAlloc(MEM_SERVER, (size_t)pathLength * sizeof(int));
+    char *text = (char *)memAlloc(MEM_SERVER, (size_t)pathLength * POLYLINE_MAX_CHARS + 1);
+    if (!cumulative || !text)
+    {
+        printf("Error: Memory allocation failed for polyline!\n");
+        memFree(cumulative);
+        memFree(text);
+        return NULL;
+    }
+
+    cumulative[0] = 0;
+    for (int i = 1; i < pathLength; i++)
+    {
+        int hop = shortestRoad(g, pathIDs[i - 1], pathIDs[i]);
+        if (hop == -1 || cumulative[i - 1] > INT_MAX - hop)
+        {
+            if (hop == -1)
+                printf("Error: No road from %d to %d!\n", pathIDs[i - 1], pathIDs[i]);
+            else
+                printf("Error: Route too long to encode!\n");
+            memFree(cumulative);
+            memFree(text);
+            return NULL;
+        }
+        cumulative[i] = cumulative[i - 1] + hop;
+    }
+
+    encodePolyline(cumulative, pathLength, 1, text);
+    memFree(cumulative);
+    return text;
+}
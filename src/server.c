@@ -0,0 +1,1346 @@
+#define _POSIX_C_SOURCE 200809L    // pthread_rwlock_t, fdopen and nanosleep under -std=c11
+#include "server.h"
+#include "render.h"
+#include "memtrack.h"
+#include <pthread.h>
+#include <sys/stat.h>
+#if defined(_WIN32)
+#include <io.h>
+#include <windows.h>
+#define dup _dup
+#define dup2 _dup2
+#define fileno _fileno
+#define fdopen _fdopen
+#else
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <errno.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#endif
+
+// SERVER STATE
+
+/**
+ * Shared server state
+ * queues, mutations, metrics and runningBatch are guarded by lock;
+ * workers read the graph under graphLock, the writer takes it exclusively
+ */
+typedef struct Server {
+    Graph *g;
+    pthread_rwlock_t graphLock;
+    ServerConfig config;
+    FILE *out;
+    RequestQueue queues[NUM_REQUEST_CLASSES];
+    ClassMetrics metrics[NUM_REQUEST_CLASSES];
+    int runningBatch;           // Batch jobs currently on a worker
+    int shuttingDown;           // No more requests will arrive
+    pthread_mutex_t lock;
+    pthread_cond_t ready;       // Signalled when work may be available
+    RequestQueue mutations;     // Mutations in arrival order, for the writer
+    pthread_cond_t mutationReady;
+    pthread_t writer;
+    pthread_mutex_t outLock;    // Keeps response lines whole
+    GraphLoader *loader;        // Background load, or NULL
+    LoadStage lastLoadStage;    // Last stage broadcast (loader thread only)
+    MapFingerprint fingerprint; // Map files as of the last RELOAD or swap (write lock)
+    pthread_t watcher;          // Map file watcher, if watching
+    int watching;
+    long versionsSwapped;       // Graph versions rebuilt from changed files
+} Server;
+
+static const char *className(RequestClass cls)
+{
+    return cls == CLASS_INTERACTIVE ? "interactive" : "batch";
+}
+
+// CONFIGURATION
+/**
+ * Default server configuration
+ */
+void initServerConfig(ServerConfig *config)
+{
+    config->numWorkers = 4;
+    config->maxConcurrentBatch = 1;
+    config->queueCapacity[CLASS_INTERACTIVE] = 64;
+    config->queueCapacity[CLASS_BATCH] = 16;
+    config->budgetMs[CLASS_INTERACTIVE] = 250.0;
+    config->budgetMs[CLASS_BATCH] = 30000.0;
+    config->citiesFile = NULL;
+    config->roadsFile = NULL;
+    config->watchFiles = 1;
+}
+
+// LOADING
+/**
+ * Base graph complete - queries and mutations may run
+ */
+static int graphQueryable(Server *s)
+{
+    return !s->loader || getLoadProgress(s->loader, NULL) >= LOAD_INDICES;
+}
+
+/**
+ * CSR cache still being built - A* would rebuild it per query
+ */
+static int graphIndexing(Server *s)
+{
+    return s->loader && getLoadProgress(s->loader, NULL) == LOAD_INDICES;
+}
+
+/**
+ * Loader callback - broadcast stage changes
+ */
+static void broadcastLoadProgress(const LoadProgress *progress, void *userData)
+{
+    Server *s = (Server *)userData;
+    if (progress->stage == s->lastLoadStage)
+        return;
+    s->lastLoadStage = progress->stage;
+
+    pthread_mutex_lock(&s->outLock);
+    fprintf(s->out, "* EVENT LOAD %s %ld %ld\n", loadStageName(progress->stage),
+            progress->citiesLoaded, progress->roadsLoaded);
+    fflush(s->out);
+    pthread_mutex_unlock(&s->outLock);
+}
+
+// HOT RELOAD
+/**
+ * No more requests will arrive
+ */
+static int serverStopping(Server *s)
+{
+    pthread_mutex_lock(&s->lock);
+    int stopping = s->shuttingDown;
+    pthread_mutex_unlock(&s->lock);
+    return stopping;
+}
+
+/**
+ * Build a new graph version from the map files and swap it in
+ * The swap exchanges the Graph contents under the write lock, so it waits
+ * for in-flight queries to finish on the old version, later requests see
+ * the new one, and the caller's Graph pointer stays valid. The version
+ * number keeps increasing, which invalidates PathResults and AvoidSets
+ * taken from the old version. Edits applied through ADDCITY and friends
+ * since the files were written are replaced, as by a restart. The reload
+ * fingerprint moves to the new files, so a later RELOAD finds no change.
+ */
+static void swapInNewVersion(Server *s)
+{
+    double startMs = currentTimeMs();
+
+    // Both versions are alive until the swap; make room by dropping
+    // optional indices of the current one, or keep serving it
+    MemStats mem;
+    getMemStats(&mem);
+    size_t needed = mem.bytes[MEM_GRAPH] + mem.bytes[MEM_EDGES] + mem.bytes[MEM_INDICES];
+    if (!memoryFits(needed))
+    {
+        pthread_rwlock_wrlock(&s->graphLock);
+        trimGraphCaches(s->g, needed);
+        pthread_rwlock_unlock(&s->graphLock);
+        if (!memoryFits(needed))
+        {
+            noteMemoryRefusal("graph version rebuild");
+            return;
+        }
+    }
+
+    Graph *next = createGraph(64);
+    if (!next)
+        return;
+    next->symmetric = s->g->symmetric;   // Only this thread swaps, so s->g is stable
+    next->quiet = 1;
+
+    // Taken before the load: a write in between is diffed again by RELOAD,
+    // never skipped
+    MapFingerprint fingerprint;
+    initMapFingerprint(&fingerprint);
+    if (!takeMapFingerprint(&fingerprint, s->config.citiesFile, s->config.roadsFile) ||
+        !loadGraphFromFiles(next, s->config.citiesFile, s->config.roadsFile))
+    {
+        // Missing or half-written file: keep serving the current version
+        freeMapFingerprint(&fingerprint);
+        freeGraph(next);
+        return;
+    }
+
+    pthread_rwlock_wrlock(&s->graphLock);
+    Graph old = *s->g;
+    *s->g = *next;
+    s->g->listener = old.listener;
+    s->g->listenerData = old.listenerData;
+    s->g->quiet = old.quiet;
+    s->g->version = old.version + 1;
+    *next = old;
+    next->listener = NULL;
+    MapFingerprint stale = s->fingerprint;
+    s->fingerprint = fingerprint;       // RELOAD now diffs against the swapped-in files
+    int cities = s->g->numCities;
+    int roads = s->g->csr ? s->g->csr->numEdges : 0;
+    pthread_rwlock_unlock(&s->graphLock);
+    freeGraph(next);
+    freeMapFingerprint(&stale);
+
+    pthread_mutex_lock(&s->lock);
+    long swapped = ++s->versionsSwapped;
+    pthread_mutex_unlock(&s->lock);
+
+    pthread_mutex_lock(&s->outLock);
+    fprintf(s->out, "* EVENT VERSION %ld %d %d\n", swapped, cities, roads);
+    fflush(s->out);
+    pthread_mutex_unlock(&s->outLock);
+    printf("✓ Graph version %ld swapped in (%d cities, %d roads) after %.1f ms\n", swapped,
+           cities, roads, currentTimeMs() - startMs);
+}
+
+#ifdef __linux__
+/**
+ * Directory holding file (into dir) and the file's base name
+ */
+static const char *splitPath(const char *file, char *dir, size_t size)
+{
+    const char *slash = strrchr(file, '/');
+    if (!slash)
+    {
+        snprintf(dir, size, ".");
+        return file;
+    }
+    snprintf(dir, size, "%.*s", slash == file ? 1 : (int)(slash - file), file);
+    return slash + 1;
+}
+
+/**
+ * Watcher thread - rebuild once the map files have been quiet for
+ * SERVER_WATCH_SETTLE_MS, and not before the initial load is done
+ */
+static void *watcherMain(void *arg)
+{
+    Server *s = (Server *)arg;
+    char citiesDir[1024], roadsDir[1024];
+    const char *citiesName = splitPath(s->config.citiesFile, citiesDir, sizeof(citiesDir));
+    const char *roadsName = splitPath(s->config.roadsFile, roadsDir, sizeof(roadsDir));
+
+    // Writers either rewrite in place (close) or rename a temporary file over
+    int fd = inotify_init();
+    int citiesWatch = fd < 0 ? -1 : inotify_add_watch(fd, citiesDir, IN_CLOSE_WRITE | IN_MOVED_TO);
+    int roadsWatch = fd < 0 ? -1 : inotify_add_watch(fd, roadsDir, IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (citiesWatch < 0 || roadsWatch < 0)
+    {
+        printf("Warning: Could not watch the map files, hot reload disabled\n");
+        if (fd >= 0)
+            close(fd);
+        return NULL;
+    }
+
+    char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    int pending = 0;
+    while (!serverStopping(s))
+    {
+        struct pollfd pfd = {fd, POLLIN, 0};
+        int ready = poll(&pfd, 1, pending ? SERVER_WATCH_SETTLE_MS : SERVER_WATCH_POLL_MS);
+        if (ready < 0 && errno != EINTR)
+            break;
+        if (ready == 0)
+        {
+            if (pending && (!s->loader || getLoadProgress(s->loader, NULL) >= LOAD_READY))
+            {
+                swapInNewVersion(s);
+                pending = 0;
+            }
+            continue;
+        }
+        if (ready < 0)
+            continue;
+
+        ssize_t len = read(fd, buffer, sizeof(buffer));
+        const struct inotify_event *ev;
+        for (char *p = buffer; len > 0 && p < buffer + len; p += sizeof(*ev) + ev->len)
+        {
+            ev = (const struct inotify_event *)p;
+            if (ev->len && ((ev->wd == citiesWatch && strcmp(ev->name, citiesName) == 0) ||
+                            (ev->wd == roadsWatch && strcmp(ev->name, roadsName) == 0)))
+                pending = 1;
+        }
+    }
+    close(fd);
+    return NULL;
+}
+#else
+/**
+ * Size and modification time of a file, both -1 if it is missing
+ */
+typedef struct FileStamp {
+    long long size;
+    long long mtime;
+} FileStamp;
+
+static FileStamp stampFile(const char *file)
+{
+    struct stat st;
+    FileStamp stamp = {-1, -1};
+    if (stat(file, &st) == 0)
+    {
+        stamp.size = (long long)st.st_size;
+        stamp.mtime = (long long)st.st_mtime;
+    }
+    return stamp;
+}
+
+static void sleepMs(int ms)
+{
+#if defined(_WIN32)
+    Sleep(ms);
+#else
+    struct timespec ts = {ms / 1000, (ms % 1000) * 1000000L};
+    nanosleep(&ts, NULL);
+#endif
+}
+
+/**
+ * Watcher thread without inotify - poll both files' size and mtime every
+ * SERVER_WATCH_POLL_MS, then rebuild as above once they have been quiet
+ * for SERVER_WATCH_SETTLE_MS
+ */
+static void *watcherMain(void *arg)
+{
+    Server *s = (Server *)arg;
+    FileStamp cities = stampFile(s->config.citiesFile);
+    FileStamp roads = stampFile(s->config.roadsFile);
+    double changedMs = 0;
+    int pending = 0;
+
+    while (!serverStopping(s))
+    {
+        sleepMs(SERVER_WATCH_POLL_MS);
+        FileStamp c = stampFile(s->config.citiesFile);
+        FileStamp r = stampFile(s->config.roadsFile);
+        if (c.size != cities.size || c.mtime != cities.mtime || r.size != roads.size ||
+            r.mtime != roads.mtime)
+        {
+            cities = c;
+            roads = r;
+            changedMs = currentTimeMs();
+            pending = 1;
+            continue;
+        }
+        if (pending && currentTimeMs() - changedMs >= SERVER_WATCH_SETTLE_MS &&
+            (!s->loader || getLoadProgress(s->loader, NULL) >= LOAD_READY))
+        {
+            swapInNewVersion(s);
+            pending = 0;
+        }
+    }
+    return NULL;
+}
+#endif
+
+/**
+ * Start watching the map files; 1 if the watcher thread runs
+ */
+static int startWatcher(Server *s)
+{
+    return pthread_create(&s->watcher, NULL, watcherMain, s) == 0;
+}
+
+// REQUEST QUEUE
+/**
+ * Push request, 0 if the queue is full
+ */
+static int queuePush(RequestQueue *q, const ServerRequest *req)
+{
+    if (q->count >= q->capacity)
+        return 0;
+    q->items[(q->head + q->count) % q->capacity] = *req;
+    q->count++;
+    return 1;
+}
+
+/**
+ * Pop oldest request into req
+ */
+static void queuePop(RequestQueue *q, ServerRequest *req)
+{
+    *req = q->items[q->head];
+    q->head = (q->head + 1) % q->capacity;
+    q->count--;
+}
+
+// METRICS
+/**
+ * Record one completed request (lock held)
+ */
+static void recordLatency(ClassMetrics *m, double latencyMs)
+{
+    m->completed++;
+    m->totalLatencyMs += latencyMs;
+    if (latencyMs > m->maxLatencyMs)
+        m->maxLatencyMs = latencyMs;
+
+    m->samples[m->nextSample] = latencyMs;
+    m->nextSample = (m->nextSample + 1) % SERVER_LATENCY_SAMPLES;
+    if (m->numSamples < SERVER_LATENCY_SAMPLES)
+        m->numSamples++;
+}
+
+static int compareDouble(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Percentile over recent samples (sorted copy)
+ */
+static double latencyPercentile(const double *sorted, int count, double p)
+{
+    if (count == 0)
+        return 0.0;
+    int i = (int)(p * (count - 1) + 0.5);
+    return sorted[i];
+}
+
+// RESPONSES
+/**
+ * Write one complete response line
+ */
+static void respond(Server *s, const char *tag, const char *fmt, const char *arg)
+{
+    pthread_mutex_lock(&s->outLock);
+    fprintf(s->out, "%s ", tag);
+    fprintf(s->out, fmt, arg);
+    fprintf(s->out, "\n");
+    fflush(s->out);
+    pthread_mutex_unlock(&s->outLock);
+}
+
+/**
+ * Respond to STATS with per-class metrics
+ */
+static void respondStats(Server *s, const char *tag)
+{
+    double sorted[SERVER_LATENCY_SAMPLES];
+
+    pthread_mutex_lock(&s->lock);
+    pthread_mutex_lock(&s->outLock);
+    fprintf(s->out, "%s OK", tag);
+    for (int c = 0; c < NUM_REQUEST_CLASSES; c++)
+    {
+        ClassMetrics *m = &s->metrics[c];
+        memcpy(sorted, m->samples, m->numSamples * sizeof(double));
+        qsort(sorted, m->numSamples, sizeof(double), compareDouble);
+
+        fprintf(s->out, " %s accepted=%ld rejected=%ld completed=%ld timeout=%ld queued=%d"
+                        " avg=%.3f p50=%.3f p99=%.3f max=%.3f",
+                className((RequestClass)c), m->accepted, m->rejected, m->completed,
+                m->timedOut, s->queues[c].count,
+                m->completed ? m->totalLatencyMs / m->completed : 0.0,
+                latencyPercentile(sorted, m->numSamples, 0.50),
+                latencyPercentile(sorted, m->numSamples, 0.99),
+                m->maxLatencyMs);
+    }
+    if (s->watching)
+        fprintf(s->out, " versions=%ld", s->versionsSwapped);
+    if (s->loader)
+    {
+        LoadProgress p;
+        getLoadProgress(s->loader, &p);
+        fprintf(s->out, " load=%s cities=%ld roads=%ld rejected=%ld loadms=%.1f",
+                loadStageName(p.stage), p.citiesLoaded, p.roadsLoaded, p.rowsRejected,
+                p.elapsedMs);
+    }
+    fprintf(s->out, "\n");
+    fflush(s->out);
+    pthread_mutex_unlock(&s->outLock);
+    pthread_mutex_unlock(&s->lock);
+}
+
+/**
+ * Respond to MEMSTATS with the tracked bytes per subsystem
+ */
+static void respondMemStats(Server *s, const char *tag)
+{
+    MemStats mem;
+    getMemStats(&mem);
+
+    pthread_mutex_lock(&s->outLock);
+    fprintf(s->out, "%s OK total=%zu peak=%zu budget=%zu refused=%ld mapped=%zu", tag,
+            mem.total, mem.peak, mem.budget, mem.refusals, mem.mapped);
+    for (int i = 0; i < NUM_MEM_SUBSYSTEMS; i++)
+        fprintf(s->out, " %s=%zu", memSubsystemName((MemSubsystem)i), mem.bytes[i]);
+    fprintf(s->out, "\n");
+    fflush(s->out);
+    pthread_mutex_unlock(&s->outLock);
+}
+
+/**
+ * Parse up to maxIDs integers following the command word
+ */
+static int parseIDList(const char *args, int *ids, int maxIDs)
+{
+    int count = 0, used = 0;
+    while (count < maxIDs && sscanf(args, "%d%n", &ids[count], &used) == 1)
+    {
+        args += used;
+        count++;
+    }
+    return count;
+}
+
+// REQUEST HANDLERS
+/**
+ * Parsed ROUTE options
+ */
+typedef struct RouteOptions {
+    int wantGeometry;       // POLYLINE
+    int wantDistances;      // DISTANCES
+    AvoidSet *avoid;        // AVOID / AVOIDROAD, NULL if none
+    int *waypoints;         // from, VIA cities..., to
+    int numWaypoints;
+    int maxWaypoints;
+} RouteOptions;
+
+/**
+ * Parse ROUTE options: POLYLINE, DISTANCES, VIA <id> ..., AVOID <id> ...,
+ * AVOIDROAD <from> <to> ... Returns NULL on success, or the error to report
+ */
+static const char *parseRouteOptions(Server *s, const char *args, RouteOptions *ro)
+{
+    char word[32];
+    int used, mode = 0, roadFrom = 0, haveFrom = 0;
+
+    while (sscanf(args, "%31s%n", word, &used) == 1)
+    {
+        args += used;
+        char *end;
+        long id = strtol(word, &end, 10);
+
+        if (strcmp(word, "POLYLINE") == 0)
+            ro->wantGeometry = 1;
+        else if (strcmp(word, "DISTANCES") == 0)
+            ro->wantDistances = 1;
+        else if (strcmp(word, "VIA") == 0 && !haveFrom)
+            mode = 3;
+        else if (strcmp(word, "AVOID") == 0 || strcmp(word, "AVOIDROAD") == 0)
+        {
+            if (haveFrom)
+                return "AVOIDROAD needs city pairs";
+            mode = strcmp(word, "AVOID") == 0 ? 1 : 2;
+            if (!ro->avoid && !(ro->avoid = createAvoidSet(s->g)))
+                return "out of memory";
+        }
+        else if (mode != 0 && *end == '\0' && end != word)
+        {
+            if (mode == 1 && !avoidCity(ro->avoid, s->g, (int)id))
+                return "unknown avoided city";
+            if (mode == 2 && !haveFrom)
+            {
+                roadFrom = (int)id;
+                haveFrom = 1;
+            }
+            else if (mode == 2)
+            {
+                if (!avoidRoad(ro->avoid, s->g, roadFrom, (int)id))
+                    return "unknown avoided road";
+                haveFrom = 0;
+            }
+            if (mode == 3)
+            {
+                if (ro->numWaypoints >= ro->maxWaypoints - 1)
+                    return "too many waypoints";
+                ro->waypoints[ro->numWaypoints++] = (int)id;
+            }
+        }
+        else
+            return "usage: ROUTE DIJKSTRA|ASTAR <from> <to> [POLYLINE] [DISTANCES] "
+                   "[VIA <id> ...] [AVOID <id> ...] [AVOIDROAD <from> <to> ...]";
+    }
+    return haveFrom ? "AVOIDROAD needs city pairs" : NULL;
+}
+
+/**
+ * ROUTE DIJKSTRA|ASTAR <fromID> <toID> [options]
+ */
+static void handleRoute(Server *s, const ServerRequest *req, SearchControl *ctl)
+{
+    char algorithm[16];
+    int fromID, toID, used = 0;
+
+    if (sscanf(req->line, "ROUTE %15s %d %d%n", algorithm, &fromID, &toID, &used) != 3)
+    {
+        respond(s, req->tag, "ERROR %s", "usage: ROUTE DIJKSTRA|ASTAR <from> <to> [options]");
+        return;
+    }
+
+    SearchOptions opts;
+    initSearchOptions(&opts);
+    if (strcmp(algorithm, "ASTAR") == 0)
+        opts.epsilon = graphIndexing(s) ? 0.0 : 1.0;
+    else if (strcmp(algorithm, "DIJKSTRA") != 0)
+    {
+        respond(s, req->tag, "ERROR %s", "unknown algorithm");
+        return;
+    }
+
+    RouteOptions ro;
+    memset(&ro, 0, sizeof(ro));
+    ro.maxWaypoints = SERVER_MAX_LINE / 2;
+    ro.waypoints = (int *)memAlloc(MEM_SERVER, ro.maxWaypoints * sizeof(int));
+    if (!ro.waypoints)
+    {
+        respond(s, req->tag, "ERROR %s", "out of memory");
+        return;
+    }
+    ro.waypoints[ro.numWaypoints++] = fromID;
+
+    const char *error = parseRouteOptions(s, req->line + used, &ro);
+    if (error || !setAvoidFilter(&opts, ro.avoid, s->g))
+    {
+        respond(s, req->tag, "ERROR %s", error ? error : "graph changed");
+        freeAvoidSet(ro.avoid);
+        memFree(ro.waypoints);
+        return;
+    }
+    ro.waypoints[ro.numWaypoints++] = toID;
+
+    PathResult *pr = ro.numWaypoints > 2
+                         ? routeVia(s->g, ro.waypoints, ro.numWaypoints, &opts, ctl)
+                         : searchPath(s->g, fromID, toID, &opts, ctl);
+    freeAvoidSet(ro.avoid);
+    memFree(ro.waypoints);
+
+    if (!pr)
+    {
+        respond(s, req->tag, "ERROR %s", "unknown city");
+        return;
+    }
+
+    if (ctl->status == SEARCH_DEADLINE || ctl->status == SEARCH_CANCELLED)
+        respond(s, req->tag, "%s", "TIMEOUT");
+    else if (pr->pathLength == 0)
+        respond(s, req->tag, "%s", "NOPATH");
+    else if (!getPath(pr))
+        respond(s, req->tag, "ERROR %s", "out of memory");
+    else
+    {
+        char *geometry = ro.wantGeometry ? encodeRouteGeometry(s->g, pr->path, pr->pathLength) : NULL;
+        char *distances = ro.wantDistances ? encodeRouteDistances(s->g, pr->path, pr->pathLength) : NULL;
+
+        pthread_mutex_lock(&s->outLock);
+        fprintf(s->out, "%s OK " DIST_FMT " %d", req->tag, pr->totalDistance, pr->pathLength);
+        for (int i = 0; i < pr->pathLength; i++)
+            fprintf(s->out, " %d", pr->path[i]);
+        if (pr->numSegments > 0)
+        {
+            fprintf(s->out, " SEGMENTS %d", pr->numSegments);
+            for (int i = 0; i < pr->numSegments; i++)
+                fprintf(s->out, " %d", pr->segmentEnds[i]);
+        }
+        if (geometry)
+            fprintf(s->out, " POLYLINE %s", geometry);
+        if (distances)
+            fprintf(s->out, " DISTANCES %s", distances);
+        fprintf(s->out, "\n");
+        fflush(s->out);
+        pthread_mutex_unlock(&s->outLock);
+        memFree(geometry);
+        memFree(distances);
+
+        GraphEvent ev = { EVENT_PATH_HIGHLIGHTED, fromID, toID, pr->totalDistance,
+                          pr->path, pr->pathLength };
+        emitGraphEvent(s->g, &ev);
+    }
+    freePathResult(pr);
+}
+
+/**
+ * MATRIX <id> <id> ... - all-pairs distances among the listed cities
+ */
+static void handleMatrix(Server *s, const ServerRequest *req, SearchControl *ctl)
+{
+    int maxIDs = SERVER_MAX_LINE / 2;
+    int *ids = (int *)memAlloc(MEM_SERVER, maxIDs * sizeof(int));
+    if (!ids)
+    {
+        respond(s, req->tag, "ERROR %s", "out of memory");
+        return;
+    }
+
+    int k = parseIDList(req->line + strlen("MATRIX"), ids, maxIDs);
+    int n = s->g->numCities;
+    size_t cells = (size_t)(k > 0 ? k : 1) * (k > 0 ? k : 1);
+    if (k > 0 && !memoryFits(cells * sizeof(dist_t) + (size_t)n * (sizeof(dist_t) + sizeof(int))))
+    {
+        noteMemoryRefusal("MATRIX request");
+        respond(s, req->tag, "ERROR %s", "memory budget");
+        memFree(ids);
+        return;
+    }
+    dist_t *dist = (dist_t *)memAlloc(MEM_SERVER, cells * sizeof(dist_t));
+    if (k == 0 || !dist)
+    {
+        respond(s, req->tag, "ERROR %s", k == 0 ? "usage: MATRIX <id> <id> ..." : "out of memory");
+        memFree(ids);
+        memFree(dist);
+        return;
+    }
+
+    // One shortest-path tree per row instead of k point-to-point searches
+    dist_t *tree = (dist_t *)memAlloc(MEM_SERVER, (n > 0 ? n : 1) * sizeof(dist_t));
+    int *parent = (int *)memAlloc(MEM_SERVER, (n > 0 ? n : 1) * sizeof(int));
+    if (!tree || !parent)
+    {
+        respond(s, req->tag, "ERROR %s", "out of memory");
+        memFree(ids);
+        memFree(dist);
+        memFree(tree);
+        memFree(parent);
+        return;
+    }
+
+    int stopped = 0;
+    for (int i = 0; i < k && !stopped; i++)
+    {
+        int ok = shortestPathTree(s->g, ids[i], NULL, tree, parent, ctl);
+        stopped = ctl->status == SEARCH_DEADLINE || ctl->status == SEARCH_CANCELLED;
+        for (int j = 0; j < k; j++)
+        {
+            int idx = ok ? findCityIndex(s->g, ids[j]) : -1;
+            dist[i * k + j] = (idx != -1 && tree[idx] != INF) ? tree[idx] : -1;
+        }
+    }
+    memFree(tree);
+    memFree(parent);
+
+    if (stopped)
+    {
+        respond(s, req->tag, "%s", "TIMEOUT");
+    }
+    else
+    {
+        pthread_mutex_lock(&s->outLock);
+        fprintf(s->out, "%s OK %d", req->tag, k);
+        for (int i = 0; i < k * k; i++)
+            fprintf(s->out, " " DIST_FMT, dist[i]);
+        fprintf(s->out, "\n");
+        fflush(s->out);
+        pthread_mutex_unlock(&s->outLock);
+    }
+    memFree(ids);
+    memFree(dist);
+}
+
+/**
+ * RENDER <minX> <minY> <maxX> <maxY> <widthPx> <heightPx> [pathID ...]
+ */
+static void handleRender(Server *s, const ServerRequest *req)
+{
+    Viewport vp;
+    int used = 0;
+
+    if (sscanf(req->line, "RENDER %lf %lf %lf %lf %d %d%n", &vp.minX, &vp.minY,
+               &vp.maxX, &vp.maxY, &vp.widthPx, &vp.heightPx, &used) != 6)
+    {
+        respond(s, req->tag, "ERROR %s", "usage: RENDER <minX> <minY> <maxX> <maxY> <w> <h> [POLYLINE] [path ...]");
+        return;
+    }
+
+    const char *args = req->line + used;
+    while (*args == ' ')
+        args++;
+    int encodePath = strncmp(args, "POLYLINE", 8) == 0;
+    if (encodePath)
+        args += 8;
+
+    int maxIDs = SERVER_MAX_LINE / 2;
+    int *path = (int *)memAlloc(MEM_SERVER, maxIDs * sizeof(int));
+    if (!path)
+    {
+        respond(s, req->tag, "ERROR %s", "out of memory");
+        return;
+    }
+    int pathLength = parseIDList(args, path, maxIDs);
+
+    RenderFeed *feed = buildRenderFeed(s->g, &vp, RENDER_CLUSTER_PX, RENDER_MIN_EDGE_PX,
+                                       path, pathLength);
+    if (!feed)
+    {
+        respond(s, req->tag, "ERROR %s", "invalid viewport");
+    }
+    else
+    {
+        pthread_mutex_lock(&s->outLock);
+        fprintf(s->out, "%s OK ", req->tag);
+        writeRenderFeed(feed, s->out, encodePath);
+        fprintf(s->out, "\n");
+        fflush(s->out);
+        pthread_mutex_unlock(&s->outLock);
+    }
+    freeRenderFeed(feed);
+    memFree(path);
+}
+
+/**
+ * HOPS <id> <id> ... - hop-distance rows (columns in city order)
+ */
+static void handleHops(Server *s, const ServerRequest *req, SearchControl *ctl)
+{
+    int maxIDs = SERVER_MAX_LINE / 2;
+    int n = s->g->numCities;
+    int *ids = (int *)memAlloc(MEM_SERVER, maxIDs * sizeof(int));
+    if (!ids)
+    {
+        respond(s, req->tag, "ERROR %s", "out of memory");
+        return;
+    }
+
+    int k = parseIDList(req->line + strlen("HOPS"), ids, maxIDs);
+    for (int i = 0; i < k; i++)
+    {
+        if (findCityIndex(s->g, ids[i]) == -1)
+        {
+            respond(s, req->tag, "ERROR %s", "unknown city");
+            memFree(ids);
+            return;
+        }
+    }
+    size_t cells = (size_t)(k > 0 ? k : 1) * (n > 0 ? n : 1);
+    // Result rows plus the three bitset frontiers multiSourceBFS keeps per city
+    size_t scratch = 3 * (size_t)(n > 0 ? n : 1) * MSBFS_WORDS * sizeof(uint64_t);
+    if (k > 0 && !memoryFits(cells * sizeof(int) + scratch))
+    {
+        noteMemoryRefusal("HOPS request");
+        respond(s, req->tag, "ERROR %s", "memory budget");
+        memFree(ids);
+        return;
+    }
+    int *hops = (int *)memAlloc(MEM_SERVER, cells * sizeof(int));
+    if (k == 0 || !hops)
+    {
+        respond(s, req->tag, "ERROR %s", k == 0 ? "usage: HOPS <id> <id> ..." : "out of memory");
+        memFree(ids);
+        memFree(hops);
+        return;
+    }
+
+    if (!multiSourceBFS(s->g, ids, k, hops, ctl))
+    {
+        respond(s, req->tag, "%s", ctl->status == SEARCH_OK ? "ERROR bfs failed" : "TIMEOUT");
+    }
+    else
+    {
+        pthread_mutex_lock(&s->outLock);
+        fprintf(s->out, "%s OK %d %d", req->tag, k, n);
+        for (long i = 0; i < (long)k * n; i++)
+            fprintf(s->out, " %d", hops[i]);
+        fprintf(s->out, "\n");
+        fflush(s->out);
+        pthread_mutex_unlock(&s->outLock);
+    }
+    memFree(ids);
+    memFree(hops);
+}
+
+/**
+ * Write one histogram as comma-separated counts
+ */
+static void writeHistogram(FILE *out, const char *name, const long *counts, int numBuckets)
+{
+    fprintf(out, " %s=", name);
+    for (int b = 0; b < numBuckets; b++)
+        fprintf(out, "%s%ld", b ? "," : "", counts[b]);
+}
+
+/**
+ * GRAPHSTATS - structure summary and histograms from graphStats
+ */
+static void handleGraphStats(Server *s, const ServerRequest *req)
+{
+    GraphStats stats;
+    if (!graphStats(s->g, &stats, 0))
+    {
+        respond(s, req->tag, "ERROR %s", "out of memory");
+        return;
+    }
+
+    pthread_mutex_lock(&s->outLock);
+    fprintf(s->out, "%s OK cities=%d roads=%d selfloops=%ld duplicates=%ld sccs=%d largest=%d"
+                    " bbox=%d,%d,%d,%d weight=%d,%d,%.1f",
+            req->tag, stats.numCities, stats.numEdges, stats.selfLoops, stats.duplicates,
+            stats.numComponents, stats.largestComponent, stats.minX, stats.minY, stats.maxX,
+            stats.maxY, stats.minWeight, stats.maxWeight,
+            stats.numEdges ? (double)stats.totalWeight / stats.numEdges : 0.0);
+    writeHistogram(s->out, "indeg", stats.inDegree, STATS_DEGREE_BUCKETS);
+    writeHistogram(s->out, "outdeg", stats.outDegree, STATS_DEGREE_BUCKETS);
+    writeHistogram(s->out, "weights", stats.weights, STATS_WEIGHT_BUCKETS);
+    fprintf(s->out, " ms=%.2f threads=%d\n", stats.elapsedMs, stats.threads);
+    fflush(s->out);
+    pthread_mutex_unlock(&s->outLock);
+}
+
+// CHANGE EVENTS
+/**
+ * Graph listener - broadcast each change as an untagged "*" line
+ */
+static void broadcastEvent(Graph *g, const GraphEvent *ev, void *userData)
+{
+    Server *s = (Server *)userData;
+    (void)g;
+
+    pthread_mutex_lock(&s->outLock);
+    switch (ev->type)
+    {
+    case EVENT_CITY_ADDED:
+    {
+        int idx = findCityIndex(s->g, ev->cityID);
+        if (idx != -1)
+            fprintf(s->out, "* EVENT CITY_ADDED %d %d %d %s\n", ev->cityID,
+                    s->g->cities[idx].x, s->g->cities[idx].y, s->g->cities[idx].cityName);
+        break;
+    }
+    case EVENT_CITY_UPDATED:
+    {
+        int idx = findCityIndex(s->g, ev->cityID);
+        if (idx != -1)
+            fprintf(s->out, "* EVENT CITY_UPDATED %d %d %d %s\n", ev->cityID,
+                    s->g->cities[idx].x, s->g->cities[idx].y, s->g->cities[idx].cityName);
+        break;
+    }
+    case EVENT_CITY_REMOVED:
+        fprintf(s->out, "* EVENT CITY_REMOVED %d\n", ev->cityID);
+        break;
+    case EVENT_ROAD_ADDED:
+    case EVENT_ROAD_UPDATED:
+        fprintf(s->out, "* EVENT %s %d %d %d\n",
+                ev->type == EVENT_ROAD_ADDED ? "ROAD_ADDED" : "ROAD_UPDATED",
+                ev->cityID, ev->toCityID, (int)ev->distance);
+        break;
+    case EVENT_ROAD_REMOVED:
+        fprintf(s->out, "* EVENT ROAD_REMOVED %d %d\n", ev->cityID, ev->toCityID);
+        break;
+    case EVENT_PATH_HIGHLIGHTED:
+        fprintf(s->out, "* EVENT PATH_HIGHLIGHTED %d", ev->pathLength);
+        for (int i = 0; i < ev->pathLength; i++)
+            fprintf(s->out, " %d", ev->path[i]);
+        fprintf(s->out, "\n");
+        break;
+    }
+    fflush(s->out);
+    pthread_mutex_unlock(&s->outLock);
+}
+
+/**
+ * Commands that change the graph or broadcast to views, run by the writer
+ */
+static int isMutation(const char *line)
+{
+    return strncmp(line, "ADDCITY ", 8) == 0 || strncmp(line, "DELCITY ", 8) == 0 ||
+           strncmp(line, "ADDROAD ", 8) == 0 || strncmp(line, "DELROAD ", 8) == 0 ||
+           strncmp(line, "HIGHLIGHT ", 10) == 0 || strcmp(line, "RELOAD") == 0;
+}
+
+/**
+ * Rebuild the CSR cache the change dropped, so later queries keep using
+ * it instead of building their own, then release the write lock
+ */
+static void endMutation(Server *s, int ok)
+{
+    if (ok)
+        prepareGraph(s->g);
+    pthread_rwlock_unlock(&s->graphLock);
+}
+
+/**
+ * Apply a mutation command; returns 0 if line is not a mutation
+ */
+static int handleMutation(Server *s, const ServerRequest *req)
+{
+    int a, b, c, used = 0;
+    int ok;
+
+    if (strncmp(req->line, "ADDCITY ", 8) == 0)
+    {
+        if (sscanf(req->line, "ADDCITY %d %d %d %n", &a, &b, &c, &used) != 3 || !req->line[used])
+        {
+            respond(s, req->tag, "ERROR %s", "usage: ADDCITY <id> <x> <y> <name>");
+            return 1;
+        }
+        pthread_rwlock_wrlock(&s->graphLock);
+        ok = addCity(s->g, a, req->line + used, b, c);
+        endMutation(s, ok);
+    }
+    else if (strncmp(req->line, "DELCITY ", 8) == 0)
+    {
+        if (sscanf(req->line, "DELCITY %d", &a) != 1)
+        {
+            respond(s, req->tag, "ERROR %s", "usage: DELCITY <id>");
+            return 1;
+        }
+        pthread_rwlock_wrlock(&s->graphLock);
+        ok = deleteCity(s->g, a);
+        endMutation(s, ok);
+    }
+    else if (strncmp(req->line, "ADDROAD ", 8) == 0)
+    {
+        if (sscanf(req->line, "ADDROAD %d %d %d", &a, &b, &c) != 3)
+        {
+            respond(s, req->tag, "ERROR %s", "usage: ADDROAD <from> <to> <distance>");
+            return 1;
+        }
+        pthread_rwlock_wrlock(&s->graphLock);
+        ok = addRoad(s->g, a, b, c);
+        endMutation(s, ok);
+    }
+    else if (strncmp(req->line, "DELROAD ", 8) == 0)
+    {
+        if (sscanf(req->line, "DELROAD %d %d", &a, &b) != 2)
+        {
+            respond(s, req->tag, "ERROR %s", "usage: DELROAD <from> <to>");
+            return 1;
+        }
+        pthread_rwlock_wrlock(&s->graphLock);
+        ok = removeRoad(s->g, a, b);
+        endMutation(s, ok);
+    }
+    else if (strcmp(req->line, "RELOAD") == 0)
+    {
+        if (!s->config.citiesFile || !s->config.roadsFile)
+        {
+            respond(s, req->tag, "ERROR %s", "no map files configured");
+            return 1;
+        }
+        ReloadSummary r;
+        pthread_rwlock_wrlock(&s->graphLock);
+        ok = reloadGraphFromFiles(s->g, s->config.citiesFile, s->config.roadsFile,
+                                  &s->fingerprint, &r);
+        pthread_rwlock_unlock(&s->graphLock);
+        if (!ok)
+        {
+            respond(s, req->tag, "ERROR %s", "map files unreadable");
+            return 1;
+        }
+        pthread_mutex_lock(&s->outLock);
+        fprintf(s->out,
+                "%s OK files=%d blocks=%d cities=+%ld,-%ld,~%ld roads=+%ld,-%ld,~%ld "
+                "rejected=%ld ms=%.2f\n",
+                req->tag, r.filesRead, r.blocksChanged, r.citiesAdded, r.citiesRemoved,
+                r.citiesChanged, r.roadsAdded, r.roadsRemoved, r.roadsChanged, r.rowsRejected,
+                r.elapsedMs);
+        fflush(s->out);
+        pthread_mutex_unlock(&s->outLock);
+        return 1;
+    }
+    else if (strncmp(req->line, "HIGHLIGHT ", 10) == 0)
+    {
+        int path[SERVER_MAX_LINE / 2];
+        GraphEvent ev = { EVENT_PATH_HIGHLIGHTED, -1, -1, 0, path, 0 };
+        ev.pathLength = parseIDList(req->line + 9, path, SERVER_MAX_LINE / 2);
+        pthread_rwlock_rdlock(&s->graphLock);
+        emitGraphEvent(s->g, &ev);
+        pthread_rwlock_unlock(&s->graphLock);
+        ok = 1;
+    }
+    else
+    {
+        return 0;
+    }
+
+    respond(s, req->tag, "%s", ok ? "OK" : "ERROR rejected");
+    return 1;
+}
+
+// WORKERS
+/**
+ * Worker thread - interactive first, batch only while under its cap
+ */
+static void *workerMain(void *arg)
+{
+    Server *s = (Server *)arg;
+    ServerRequest req;
+
+    for (;;)
+    {
+        pthread_mutex_lock(&s->lock);
+        for (;;)
+        {
+            if (s->queues[CLASS_INTERACTIVE].count > 0)
+            {
+                queuePop(&s->queues[CLASS_INTERACTIVE], &req);
+                break;
+            }
+            if (s->queues[CLASS_BATCH].count > 0 &&
+                s->runningBatch < s->config.maxConcurrentBatch)
+            {
+                queuePop(&s->queues[CLASS_BATCH], &req);
+                s->runningBatch++;
+                break;
+            }
+            if (s->shuttingDown && s->queues[CLASS_BATCH].count == 0)
+            {
+                pthread_mutex_unlock(&s->lock);
+                return NULL;
+            }
+            pthread_cond_wait(&s->ready, &s->lock);
+        }
+        pthread_mutex_unlock(&s->lock);
+
+        // Shed requests that already used up their budget waiting
+        double remaining = s->config.budgetMs[req.cls] - (currentTimeMs() - req.enqueuedMs);
+        int shed = remaining <= 0;
+
+        SearchControl ctl;
+        initSearchControl(&ctl, remaining);
+        pthread_rwlock_rdlock(&s->graphLock);
+        if (shed)
+            respond(s, req.tag, "BUSY %s", className(req.cls));
+        else if (strncmp(req.line, "ROUTE", 5) == 0)
+            handleRoute(s, &req, &ctl);
+        else if (strncmp(req.line, "RENDER", 6) == 0)
+            handleRender(s, &req);
+        else if (strncmp(req.line, "MATRIX", 6) == 0)
+            handleMatrix(s, &req, &ctl);
+        else if (strcmp(req.line, "GRAPHSTATS") == 0)
+            handleGraphStats(s, &req);
+        else
+            handleHops(s, &req, &ctl);
+        pthread_rwlock_unlock(&s->graphLock);
+
+        pthread_mutex_lock(&s->lock);
+        ClassMetrics *m = &s->metrics[req.cls];
+        if (shed)
+            m->rejected++;
+        else
+        {
+            if (ctl.status == SEARCH_DEADLINE)
+                m->timedOut++;
+            recordLatency(m, currentTimeMs() - req.enqueuedMs);
+        }
+        if (req.cls == CLASS_BATCH)
+        {
+            s->runningBatch--;
+            pthread_cond_broadcast(&s->ready);
+        }
+        pthread_mutex_unlock(&s->lock);
+    }
+}
+
+/**
+ * Writer thread - apply queued mutations one at a time, in arrival order,
+ * so waiting for the write lock never stalls the reader
+ */
+static void *writerMain(void *arg)
+{
+    Server *s = (Server *)arg;
+    ServerRequest req;
+
+    for (;;)
+    {
+        pthread_mutex_lock(&s->lock);
+        while (s->mutations.count == 0 && !s->shuttingDown)
+            pthread_cond_wait(&s->mutationReady, &s->lock);
+        if (s->mutations.count == 0)
+        {
+            pthread_mutex_unlock(&s->lock);
+            return NULL;
+        }
+        queuePop(&s->mutations, &req);
+        pthread_mutex_unlock(&s->lock);
+
+        handleMutation(s, &req);
+    }
+}
+
+// SERVER LOOP
+/**
+ * Read requests, classify, admit or shed
+ */
+int runServer(Graph *g, const ServerConfig *config, FILE *in, FILE *out)
+{
+    if (!g || !config || !in || !out || config->numWorkers <= 0)
+    {
+        printf("Error: Invalid parameters!\n");
+        return 0;
+    }
+
+    Server *s = (Server *)calloc(1, sizeof(Server));
+    pthread_t *workers = (pthread_t *)malloc(config->numWorkers * sizeof(pthread_t));
+    if (!s || !workers)
+    {
+        free(s);
+        free(workers);
+        printf("Error: Memory allocation failed!\n");
+        return 0;
+    }
+
+    s->g = g;
+    s->config = *config;
+    s->out = out;
+    s->mutations.capacity = SERVER_MUTATION_QUEUE;
+    s->mutations.items = (ServerRequest *)memAlloc(MEM_SERVER, SERVER_MUTATION_QUEUE * sizeof(ServerRequest));
+    for (int c = 0; c < NUM_REQUEST_CLASSES; c++)
+    {
+        s->queues[c].capacity = config->queueCapacity[c] > 0 ? config->queueCapacity[c] : 1;
+        s->queues[c].items = (ServerRequest *)memAlloc(MEM_SERVER, s->queues[c].capacity * sizeof(ServerRequest));
+        if (!s->queues[c].items || !s->mutations.items)
+        {
+            for (int k = 0; k <= c; k++)
+                memFree(s->queues[k].items);
+            memFree(s->mutations.items);
+            free(s);
+            free(workers);
+            printf("Error: Memory allocation failed!\n");
+            return 0;
+        }
+    }
+    pthread_mutex_init(&s->lock, NULL);
+    pthread_mutex_init(&s->outLock, NULL);
+    pthread_cond_init(&s->ready, NULL);
+    pthread_cond_init(&s->mutationReady, NULL);
+    pthread_rwlock_init(&s->graphLock, NULL);
+    initMapFingerprint(&s->fingerprint);
+    setGraphEventListener(g, broadcastEvent, s);
+
+    if (config->citiesFile && config->roadsFile)
+    {
+        s->lastLoadStage = (LoadStage)-1;   // Nothing broadcast yet
+        s->loader = startGraphLoad(g, config->citiesFile, config->roadsFile, &s->graphLock,
+                                   broadcastLoadProgress, s);
+        if (!s->loader)
+        {
+            // No thread - load in place, without per-city events
+            setGraphEventListener(g, NULL, NULL);
+            loadGraphFromFiles(g, config->citiesFile, config->roadsFile);
+            setGraphEventListener(g, broadcastEvent, s);
+        }
+        if (config->watchFiles)
+            s->watching = startWatcher(s);
+    }
+
+    int started = 0;
+    int writing = pthread_create(&s->writer, NULL, writerMain, s) == 0;
+    for (; writing && started < config->numWorkers; started++)
+    {
+        if (pthread_create(&workers[started], NULL, workerMain, s) != 0)
+            break;
+    }
+
+    ServerRequest req;
+    char line[SERVER_MAX_LINE + SERVER_MAX_TAG];
+    while (started > 0 && fgets(line, sizeof(line), in))
+    {
+        line[strcspn(line, "\r\n")] = 0;
+
+        int used = 0;
+        if (sscanf(line, "%31s %n", req.tag, &used) != 1)
+            continue;
+        strncpy(req.line, line + used, SERVER_MAX_LINE - 1);
+        req.line[SERVER_MAX_LINE - 1] = '\0';
+
+        if (strcmp(req.line, "QUIT") == 0)
+            break;
+        if (strcmp(req.line, "STATS") == 0)
+        {
+            respondStats(s, req.tag);
+            continue;
+        }
+        if (strcmp(req.line, "MEMSTATS") == 0)
+        {
+            respondMemStats(s, req.tag);
+            continue;
+        }
+        if (!graphQueryable(s))
+        {
+            respond(s, req.tag, "BUSY %s", "loading");
+            continue;
+        }
+        if (isMutation(req.line))
+        {
+            pthread_mutex_lock(&s->lock);
+            int queued = queuePush(&s->mutations, &req);
+            if (queued)
+                pthread_cond_signal(&s->mutationReady);
+            pthread_mutex_unlock(&s->lock);
+            if (!queued)
+                respond(s, req.tag, "BUSY %s", "mutation");
+            continue;
+        }
+
+        if (strncmp(req.line, "ROUTE ", 6) == 0 || strncmp(req.line, "RENDER ", 7) == 0)
+            req.cls = CLASS_INTERACTIVE;
+        else if (strncmp(req.line, "MATRIX ", 7) == 0 || strncmp(req.line, "HOPS ", 5) == 0 ||
+                 strcmp(req.line, "GRAPHSTATS") == 0)
+            req.cls = CLASS_BATCH;
+        else
+        {
+            respond(s, req.tag, "ERROR %s", "unknown command");
+            continue;
+        }
+        req.enqueuedMs = currentTimeMs();
+
+        // Admission control - a full queue answers BUSY instead of waiting
+        pthread_mutex_lock(&s->lock);
+        int admitted = queuePush(&s->queues[req.cls], &req);
+        if (admitted)
+        {
+            s->metrics[req.cls].accepted++;
+            pthread_cond_signal(&s->ready);
+        }
+        else
+        {
+            s->metrics[req.cls].rejected++;
+        }
+        pthread_mutex_unlock(&s->lock);
+
+        if (!admitted)
+            respond(s, req.tag, "BUSY %s", className(req.cls));
+    }
+
+    // Drain queued work, then stop workers and the writer
+    pthread_mutex_lock(&s->lock);
+    s->shuttingDown = 1;
+    pthread_cond_broadcast(&s->ready);
+    pthread_cond_broadcast(&s->mutationReady);
+    pthread_mutex_unlock(&s->lock);
+
+    for (int i = 0; i < started; i++)
+        pthread_join(workers[i], NULL);
+    if (writing)
+        pthread_join(s->writer, NULL);
+    if (s->watching)
+        pthread_join(s->watcher, NULL);
+    finishGraphLoad(s->loader);   // Stops a load still in progress
+
+    setGraphEventListener(g, NULL, NULL);
+    freeMapFingerprint(&s->fingerprint);
+    pthread_rwlock_destroy(&s->graphLock);
+    pthread_cond_destroy(&s->mutationReady);
+    pthread_cond_destroy(&s->ready);
+    pthread_mutex_destroy(&s->outLock);
+    pthread_mutex_destroy(&s->lock);
+    for (int c = 0; c < NUM_REQUEST_CLASSES; c++)
+        memFree(s->queues[c].items);
+    memFree(s->mutations.items);
+    free(s);
+    free(workers);
+    return started > 0;
+}
+
+/**
+ * Duplicate stdout for responses and send diagnostics printf to stderr
+ */
+FILE *openProtocolOutput(void)
+{
+    fflush(stdout);
+    int fd = dup(fileno(stdout));
+    if (fd < 0)
+        return NULL;
+    FILE *out = fdopen(fd, "w");
+    if (!out)
+        return NULL;
+    dup2(fileno(stderr), fileno(stdout));
+    return out;
+}